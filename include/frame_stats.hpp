@@ -0,0 +1,27 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+// how many samples each rolling statistic keeps
+#ifndef FRAME_STATS_WINDOW
+#define FRAME_STATS_WINDOW 128
+#endif
+// a statistic over its last FRAME_STATS_WINDOW samples,
+// so the percentiles follow the current load rather
+// than the whole run
+class rolling_stat {
+    uint32_t m_samples[FRAME_STATS_WINDOW];
+    size_t m_count;
+    size_t m_next;
+public:
+    rolling_stat();
+    // adds a sample, replacing the oldest
+    // once the window is full
+    void add(uint32_t value);
+    void clear();
+    // the number of samples in the window
+    size_t count() const;
+    // the sample that percent of the window is at
+    // or below. 0 when there are no samples
+    uint32_t percentile(int percent) const;
+    uint32_t max() const;
+};
@@ -0,0 +1,62 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#include <gfx.hpp>
+// wraps a font so each glyph is rasterized once into
+// an 8-bit alpha atlas and copied out of it after that.
+// The atlas is a fixed number of square cells, one
+// line high, carved from a memory budget. When it's
+// full the least recently drawn glyph is evicted.
+// Glyphs too big for a cell go to the wrapped font
+class glyph_cache : public gfx::font {
+    struct cell {
+        int32_t codepoint;
+        gfx::size16 dimensions;
+        uint32_t used;
+    };
+    gfx::font& m_font;
+    size_t m_budget;
+    uint16_t m_cell_size;
+    size_t m_cell_count;
+    uint8_t* m_atlas;
+    cell* m_cells;
+    // fast lookup for ASCII. -1 if not cached
+    mutable int16_t m_ascii[128];
+    mutable uint32_t m_tick;
+    mutable size_t m_hits;
+    mutable size_t m_misses;
+    mutable size_t m_evictions;
+    glyph_cache(const glyph_cache& rhs) = delete;
+    glyph_cache& operator=(const glyph_cache& rhs) = delete;
+    int find(int32_t codepoint) const;
+    int allocate(int32_t codepoint) const;
+public:
+    // budget is the atlas size in bytes
+    glyph_cache(gfx::font& font, size_t budget);
+    virtual ~glyph_cache();
+    // initializes the wrapped font if needed
+    // and allocates the atlas
+    virtual gfx::gfx_result initialize() override;
+    virtual bool initialized() const override;
+    virtual void deinitialize() override;
+    virtual uint16_t line_height() const override;
+    virtual uint16_t line_advance() const override;
+    virtual uint16_t base_line() const override;
+    virtual gfx::gfx_result on_measure(int32_t codepoint1,
+                                       int32_t codepoint2,
+                                       gfx::font_glyph_info* out_glyph_info) const override;
+    virtual gfx::gfx_result on_draw(gfx::bitmap<gfx::alpha_pixel<8>>& destination,
+                                    int32_t codepoint,
+                                    int32_t glyph_index = -1) const override;
+    // empties the atlas
+    void clear();
+    // the number of glyphs the atlas holds
+    size_t capacity() const;
+    // draws served from the atlas
+    size_t hits() const;
+    // draws that had to rasterize
+    size_t misses() const;
+    // glyphs evicted to make room
+    size_t evictions() const;
+};
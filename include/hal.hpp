@@ -0,0 +1,52 @@
+#pragma once
+// maps the probe's hardware onto either the
+// Arduino core or the host simulator so the
+// probe pipeline can run on both
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <Wire.h>
+// where the serial monitor output
+// goes
+#define MONITOR Serial
+// the I2C probe connections
+#define I2C Wire
+// the serial probe connections
+#define SER Serial1
+#define SER_UART UART_NUM_1
+#else
+#include "native/sim_hal.hpp"
+#define MONITOR sim_monitor
+#define I2C sim_i2c
+#define SER sim_ser
+#endif
+#define I2C_SDA 21
+#define I2C_SCL 22
+#define SER_RX 17
+// which core each task runs on. Capture and formatting
+// share one so bytes are formatted on the core they land
+// on, and rendering and flushing get the other. Override
+// per board with build flags. Single core chips run
+// everything on core 0
+#if defined(ARDUINO) && portNUM_PROCESSORS > 1
+#ifndef CAPTURE_CORE
+#define CAPTURE_CORE 0
+#endif
+#ifndef PROBE_CORE
+#define PROBE_CORE CAPTURE_CORE
+#endif
+#ifndef I2C_CORE
+#define I2C_CORE PROBE_CORE
+#endif
+#ifndef RENDER_CORE
+#define RENDER_CORE 1
+#endif
+#else
+#undef CAPTURE_CORE
+#undef PROBE_CORE
+#undef I2C_CORE
+#undef RENDER_CORE
+#define CAPTURE_CORE 0
+#define PROBE_CORE 0
+#define I2C_CORE 0
+#define RENDER_CORE 0
+#endif
@@ -0,0 +1,17 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+// table driven hex formatting. Each byte is looked
+// up rather than going through snprintf(), and on
+// little endian targets 4 bytes are written as three
+// 32-bit words at a time
+
+// writes each byte as "XX " (size*3 characters)
+// returning the number of characters written.
+// does not null terminate
+size_t hex_dump(const uint8_t* data, size_t size, char* out_text);
+// writes the bytes as a row of "XX XX XX", with no
+// trailing space (size*3-1 characters) returning
+// the number of characters written.
+// does not null terminate
+size_t hex_dump_row(const uint8_t* data, size_t size, char* out_text);
@@ -0,0 +1,86 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#include "frame_stats.hpp"
+// schedules the i2c scans. Addresses already seen, and
+// any on the watch list, are polled often so a device
+// going away or coming back shows up quickly. Full sweeps
+// find new devices. They run on a period that doubles
+// while the bus stays the same, and drops back to the
+// shortest period after any change
+
+// how often the known addresses are polled
+#ifndef I2C_POLL_MS
+#define I2C_POLL_MS 20
+#endif
+// the full sweep period bounds
+#ifndef I2C_SWEEP_MIN_MS
+#define I2C_SWEEP_MIN_MS 250
+#endif
+#ifndef I2C_SWEEP_MAX_MS
+#define I2C_SWEEP_MAX_MS 4000
+#endif
+
+// an address coming or going. ms is when the
+// scanner saw it, by millis()
+typedef struct i2c_event {
+    uint8_t address;
+    bool present;
+    uint32_t ms;
+} i2c_event_t;
+// called from update() as each change is seen. Sweeps
+// report new addresses as they answer, and the ones
+// that went away once they finish. A sweep that fails
+// part way reports nothing as gone
+typedef void (*i2c_event_callback)(const i2c_event_t& event, void* state);
+
+class i2c_scanner {
+    uint32_t m_banks[4];
+    uint32_t m_watch[4];
+    bool m_started;
+    uint32_t m_sweep_ms;
+    uint32_t m_sweep_ts;
+    uint32_t m_poll_ts;
+    size_t m_sweeps;
+    size_t m_polls;
+    size_t m_changes;
+    size_t m_failures;
+    uint32_t m_busy_us;
+    rolling_stat m_latency;
+    i2c_event_callback m_on_event;
+    void* m_on_event_state;
+    static void on_found(uint8_t address, void* state);
+    void emit(const uint32_t* old_banks, const uint32_t* mask, bool present, uint32_t now_ms);
+    bool changed(const uint32_t* old_banks, const uint32_t* mask, uint32_t since_ms);
+public:
+    i2c_scanner();
+    // adds an address to poll even if it hasn't been seen
+    void watch(uint8_t address);
+    // sets the callback for each address coming or going
+    void on_event_callback(i2c_event_callback callback, void* state = nullptr);
+    // runs a poll or a sweep if one is due, reporting
+    // true if the address list changed. The first
+    // call always sweeps
+    bool update(uint32_t now_ms);
+    // milliseconds until update() has work to do
+    uint32_t next_ms(uint32_t now_ms) const;
+    // the addresses present, as banks[4]
+    const uint32_t* banks() const;
+    // the current sweep period
+    uint32_t sweep_ms() const;
+    size_t sweeps() const;
+    size_t polls() const;
+    size_t changes() const;
+    // sweeps and polls that failed part way. A failed
+    // poll changes nothing, and a failed sweep only adds
+    // the addresses it already reported
+    size_t failures() const;
+    // time spent probing, in microseconds.
+    // It wraps after ~71 minutes
+    uint32_t busy_us() const;
+    // how long each change could have gone unseen, in
+    // milliseconds: the time since the address was last
+    // probed. Hot-plug latency is at most this
+    const rolling_stat& latency() const;
+};
@@ -0,0 +1,45 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+// keeps the probe's i2c driver installed between sweeps.
+// Installing the driver and setting the pins every sweep
+// costs time and glitches the bus, so it's only torn down
+// and installed again after a bus error or when the pins
+// or clock change. Only the scanning task may use it
+class i2c_session {
+    int m_sda;
+    int m_scl;
+    uint32_t m_freq;
+    bool m_open;
+    bool m_reset;
+    size_t m_inits;
+    size_t m_errors;
+    uint32_t m_init_us;
+    uint32_t m_last_init_us;
+    uint32_t m_max_init_us;
+    i2c_session(const i2c_session& rhs) = delete;
+    i2c_session& operator=(const i2c_session& rhs) = delete;
+public:
+    i2c_session();
+    // sets the pins and bus clock. The driver is installed
+    // again on the next open() if they changed
+    void settings(int sda, int scl, uint32_t freq);
+    uint32_t freq() const;
+    // installs the driver if it isn't already, or if
+    // the bus needs a reset. Reports false if it can't be
+    bool open();
+    // releases the driver
+    void close();
+    // reports a bus error, so the driver is
+    // installed again on the next open()
+    void error();
+    bool is_open() const;
+    // times the driver has been installed
+    size_t inits() const;
+    // bus errors reported
+    size_t errors() const;
+    // the time spent installing the driver, in microseconds
+    uint32_t init_us() const;
+    uint32_t last_init_us() const;
+    uint32_t max_init_us() const;
+};
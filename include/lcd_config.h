@@ -605,4 +605,15 @@
 #ifndef LCD_DC_BIT_OFFSET
 #define LCD_DC_BIT_OFFSET 0
 #endif
+// LCD_DIRECT_RENDER has RGB panels painted straight into the
+// frame buffer they scan out of, rather than into strip
+// buffers that are then copied there
+#ifdef LCD_DIRECT_RENDER
+#ifndef LCD_PIN_NUM_HSYNC
+#error "LCD_DIRECT_RENDER needs an RGB panel frame buffer"
+#endif
+#if LCD_SWAP_XY || (defined(LCD_SWAP_COLOR_BYTES) && LCD_SWAP_COLOR_BYTES != 0)
+#error "LCD_DIRECT_RENDER needs the frame buffer in screen order"
+#endif
+#endif
 #endif // LCD_CONFIG_H
\ No newline at end of file
@@ -10,6 +10,13 @@ esp_err_t lcd_panel_draw_bitmap(int x1, int y1, int x2, int y2, void* bitmap);
 #ifdef LCD_PIN_NUM_HSYNC
 bool lcd_panel_init();
 esp_err_t esp_lcd_new_panel_st7701();
+// the frame buffer the panel scans out of, for drawing
+// into directly. Rows are LCD_FRAME_BUFFER_STRIDE bytes
+uint8_t* lcd_panel_frame_buffer();
+// writes rows y1 to y2 of the frame buffer back from
+// the cache so the panel sees them
+void lcd_panel_frame_buffer_flush(int y1, int y2);
+#define LCD_FRAME_BUFFER_STRIDE (LCD_HRES * (LCD_BIT_DEPTH >> 3))
 #endif
 #ifndef LCD_PIN_NUM_HSYNC
 // global so it can be used after init
@@ -707,7 +714,7 @@ esp_err_t lcd_panel_draw_bitmap(int x1, int y1, int x2, int y2, void* color_data
     size_t bmp_offs = (bmp_offs_x * (LCD_BIT_DEPTH >> 3));
     size_t scr_offs = (cx1 * (LCD_BIT_DEPTH >> 3));
     size_t bmp_stride = (x2 - x1 + 1) * (LCD_BIT_DEPTH >> 3);
-    uint8_t* src = (uint8_t*)color_data + bmp_offs_y;
+    uint8_t* src = (uint8_t*)color_data + bmp_offs_y * bmp_stride;
 #if defined(LCD_BIT_DEPTH) && LCD_BIT_DEPTH == 16 && defined(LCD_SWAP_COLOR_BYTES) && LCD_SWAP_COLOR_BYTES != 0
     for (int y = 0; y < bmp_h; ++y) {
         uint8_t* dst = (uint8_t*)lcd_lines_buffer[y + cy1] + scr_offs;
@@ -734,6 +741,15 @@ esp_err_t lcd_panel_draw_bitmap(int x1, int y1, int x2, int y2, void* color_data
 #endif
     return ESP_OK;
 }
+uint8_t* lcd_panel_frame_buffer() {
+    return lcd_frame_buffer;
+}
+void lcd_panel_frame_buffer_flush(int y1, int y2) {
+#if __has_include(<esp32s3/rom/cache.h>)
+    Cache_WriteBack_Addr((uint32_t)(lcd_frame_buffer + y1 * LCD_FRAME_BUFFER_STRIDE),
+                         (y2 - y1 + 1) * LCD_FRAME_BUFFER_STRIDE);
+#endif
+}
 bool lcd_panel_init() {
 #ifdef LCD_PIN_NUM_BCKL
 #if LCD_PIN_NUM_BCKL >= 0
@@ -1048,6 +1064,13 @@ esp_err_t lcd_panel_draw_bitmap(int x1, int y1, int x2, int y2, void* bitmap) {
     }
     return result;
 }
+uint8_t* lcd_panel_frame_buffer() {
+    return lcd_frame_buffer;
+}
+void lcd_panel_frame_buffer_flush(int y1, int y2) {
+    Cache_WriteBack_Addr((uint32_t)(lcd_frame_buffer + y1 * LCD_FRAME_BUFFER_STRIDE),
+                         (y2 - y1 + 1) * LCD_FRAME_BUFFER_STRIDE);
+}
 
 bool lcd_panel_init() {
 #ifdef LCD_PIN_NUM_BCKL
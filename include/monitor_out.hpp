@@ -0,0 +1,43 @@
+#pragma once
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ring_buffer.hpp"
+// stages output for the serial monitor so each
+// refresh goes out in a single write. Writes never
+// block: when the monitor can't keep up, output
+// that doesn't fit in the staging buffer is dropped
+// and counted
+class monitor_out {
+    ring_buffer<uint8_t> m_buffer;
+    size_t m_watermark;
+    size_t m_dropped;
+    size_t m_written;
+    size_t m_flushes;
+    monitor_out(const monitor_out& rhs) = delete;
+    monitor_out& operator=(const monitor_out& rhs) = delete;
+public:
+    monitor_out();
+    // allocates the staging buffer. Staged data is
+    // sent early once it reaches the watermark
+    bool initialize(size_t capacity, size_t watermark);
+    // stages data, dropping any that doesn't fit
+    // and returning the number of bytes staged
+    size_t write(const void* data, size_t size);
+    size_t print(const char* text);
+    size_t print(char ch);
+    size_t printf(const char* format, ...);
+    size_t vprintf(const char* format, va_list args);
+    // sends as much of the staged data as the
+    // monitor can take without blocking
+    void flush();
+    // the number of bytes waiting to be sent
+    size_t size() const;
+    // bytes dropped because the staging buffer was full
+    size_t dropped() const;
+    // bytes sent to the monitor
+    size_t written() const;
+    // the number of writes to the monitor
+    size_t flushes() const;
+};
@@ -0,0 +1,33 @@
+#pragma once
+#include <stddef.h>
+// host microbenchmarks run by the native build.
+// each reports to stderr and returns a process exit code
+
+// compares the hex dump kernel against snprintf()
+int bench_hex();
+// compares the panel's per pixel byte swap loops against
+// swapping two pixels per 32-bit word, over a full frame
+int bench_swap();
+// times the i2c address seqlock's reads and writes
+// with a writer and several readers contending
+int bench_seqlock();
+// compares probe text frame times with and without
+// the glyph cache. call after ui_init()
+int bench_glyphs();
+// packs the fonts and title image into a header
+// at path. call after ui_init()
+int pack_assets(const char* path);
+// builds the packed tables in memory without writing
+// them out. call after ui_init()
+bool pack_build();
+// the checks test/test_packed_assets runs once they're
+// built: the glyphs that don't decode to what the TrueType
+// fonts draw, whether the title decodes to what the SVG
+// renders, and whether the probe screen draws the same
+size_t pack_glyph_mismatches();
+bool pack_title_matches();
+bool pack_screen_matches();
+// compares the packed assets' decode and frame
+// times with the TrueType and SVG paths. call
+// after ui_init()
+int bench_packed();
@@ -0,0 +1,144 @@
+#pragma once
+// host stand-ins for the hardware the probe talks to
+// so the pipeline can be run and measured on a PC
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <mutex>
+#include <vector>
+
+#define SERIAL_8N1 0x800001c
+
+// milliseconds since the simulator started
+uint32_t millis();
+// microseconds since the simulator started
+uint32_t micros();
+// sleeps the calling thread
+void delay(uint32_t ms);
+
+// stands in for the serial monitor port. The
+// transmit buffer drains at the baud rate
+class sim_stream {
+    FILE* m_file;
+    size_t m_written;
+    unsigned long m_baud;
+    size_t m_tx_capacity;
+    size_t m_tx_pending;
+    uint32_t m_tx_ts;
+    void drain();
+public:
+    sim_stream();
+    // a baud of zero drains immediately
+    void begin(unsigned long baud);
+    // where the output goes. nullptr discards it
+    void output(FILE* file);
+    int availableForWrite();
+    size_t write(const uint8_t* data, size_t size);
+    // total bytes written
+    size_t written() const;
+};
+
+// stands in for TwoWire. Answers address probes
+// from a script of bus states over time
+class sim_i2c_bus {
+    struct step {
+        uint32_t ms;
+        uint32_t banks[4];
+    };
+    std::vector<step> m_script;
+    uint32_t m_start_ms;
+    uint8_t m_address;
+    uint32_t m_probe_us;
+    bool m_began;
+    size_t m_probes;
+    uint64_t m_bus_us;
+    const step* current() const;
+public:
+    sim_i2c_bus();
+    // loads a script from a text file. Each line is
+    // <ms> [address ...] and sets the devices present
+    // from that time on. Addresses may be hex (0x3C)
+    bool script(const char* path);
+    // adds a single step to the script
+    void script_step(uint32_t ms, const uint32_t* banks);
+    // restarts the script clock
+    void rewind();
+    // the simulated cost of a single address probe
+    void probe_us(uint32_t value);
+    bool begin(int sda, int scl);
+    void end();
+    void setTimeOut(uint16_t timeout_ms);
+    void beginTransmission(uint8_t address);
+    uint8_t endTransmission(bool send_stop = true);
+    // total address probes issued
+    size_t probes() const;
+    // total simulated bus time in microseconds
+    uint64_t bus_us() const;
+};
+
+// stands in for HardwareSerial on the probe's
+// RX pin. Replays a file at a fixed byte rate
+// through a FIFO that overflows like the real one.
+// safe to use from more than one thread
+class sim_uart {
+    mutable std::mutex m_lock;
+    FILE* m_file;
+    bool m_loop;
+    uint32_t m_bytes_per_sec;
+    unsigned long m_baud;
+    uint32_t m_start_us;
+    uint64_t m_arrived;
+    std::vector<uint8_t> m_fifo;
+    size_t m_fifo_head;
+    size_t m_fifo_count;
+    size_t m_overflowed;
+    size_t m_received;
+    bool m_eof;
+    void pump();
+public:
+    sim_uart();
+    ~sim_uart();
+    // opens the file to replay. A bytes_per_sec of
+    // zero derives the rate from the baud (8N1)
+    bool open(const char* path, uint32_t bytes_per_sec = 0, bool loop = false);
+    // the size of the receive FIFO
+    void rx_buffer_size(size_t size);
+    void begin(unsigned long baud, uint32_t config, int8_t rx_pin, int8_t tx_pin);
+    void updateBaudRate(unsigned long baud);
+    int available();
+    size_t read(uint8_t* buffer, size_t size);
+    // true once the file has been fully delivered
+    bool eof() const;
+    // bytes that arrived while the FIFO was full
+    size_t overflowed() const;
+    // bytes that arrived at the pin
+    size_t received() const;
+};
+
+// an in memory frame buffer that stands in
+// for the LCD panel
+class sim_framebuffer {
+    uint16_t m_width;
+    uint16_t m_height;
+    size_t m_pixel_bytes;
+    std::vector<uint8_t> m_data;
+    size_t m_flushes;
+    uint64_t m_bytes;
+public:
+    sim_framebuffer();
+    void initialize(uint16_t width, uint16_t height, size_t bit_depth);
+    // copies a bitmap into the frame buffer. The
+    // coordinates are inclusive, as with the panel API
+    void draw_bitmap(int x1, int y1, int x2, int y2, const void* bitmap);
+    const uint8_t* data() const;
+    // number of draw_bitmap calls
+    size_t flushes() const;
+    // total bitmap bytes received
+    uint64_t bytes() const;
+};
+
+extern sim_stream sim_monitor;
+extern sim_i2c_bus sim_i2c;
+extern sim_uart sim_ser;
+extern sim_framebuffer sim_fb;
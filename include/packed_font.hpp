@@ -0,0 +1,82 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#include <gfx.hpp>
+// fonts and images pre-rasterized at build time by the
+// native program (-P) into run length encoded tables.
+// See tools/pack_assets.py
+
+// the runs are PackBits: a header byte of 0-127 is followed
+// by header+1 literal units, and 128-255 by one unit repeated
+// header-126 times. Glyph runs use 1 byte units (8-bit alpha)
+// and image runs 4 byte units (RGBA). Runs never cross a row
+
+// a pre-rasterized glyph
+typedef struct packed_glyph {
+    int32_t codepoint;
+    uint16_t width;
+    uint16_t height;
+    int16_t offset_x;
+    int16_t offset_y;
+    int16_t advance;
+    // where its runs start in the font's data
+    uint32_t data;
+} packed_glyph_t;
+// an advance adjustment between two glyphs
+typedef struct packed_kern {
+    int32_t codepoint1;
+    int32_t codepoint2;
+    int16_t adjust;
+} packed_kern_t;
+// a font subset at one size. Glyphs and kerns
+// are sorted by codepoint
+typedef struct packed_font_data {
+    uint16_t line_height;
+    uint16_t line_advance;
+    uint16_t base_line;
+    uint16_t glyph_count;
+    const packed_glyph_t* glyphs;
+    uint16_t kern_count;
+    const packed_kern_t* kerns;
+    const uint8_t* data;
+} packed_font_data_t;
+// a pre-rendered RGBA image
+typedef struct packed_image_data {
+    uint16_t width;
+    uint16_t height;
+    const uint8_t* data;
+} packed_image_data_t;
+
+// decodes count units of unit bytes each into out,
+// returning the number of encoded bytes consumed
+size_t packed_decode(const uint8_t* data, size_t unit, size_t count, void* out);
+// encodes count units of unit bytes each into out,
+// returning the number of bytes written. out needs
+// room for count*unit+count/128+1 bytes
+size_t packed_encode(const void* data, size_t unit, size_t count, uint8_t* out);
+
+// draws text from a packed font. Measuring is a binary
+// search of the glyph table and drawing a decode
+class packed_font : public gfx::font {
+    const packed_font_data_t* m_data;
+    int find(int32_t codepoint) const;
+public:
+    packed_font();
+    packed_font(const packed_font_data_t& data);
+    void data(const packed_font_data_t& data);
+    // nothing to load. These just report
+    // whether there's data
+    virtual gfx::gfx_result initialize() override;
+    virtual bool initialized() const override;
+    virtual void deinitialize() override;
+    virtual uint16_t line_height() const override;
+    virtual uint16_t line_advance() const override;
+    virtual uint16_t base_line() const override;
+    virtual gfx::gfx_result on_measure(int32_t codepoint1,
+                                       int32_t codepoint2,
+                                       gfx::font_glyph_info* out_glyph_info) const override;
+    virtual gfx::gfx_result on_draw(gfx::bitmap<gfx::alpha_pixel<8>>& destination,
+                                    int32_t codepoint,
+                                    int32_t glyph_index = -1) const override;
+};
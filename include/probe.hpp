@@ -0,0 +1,72 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include "i2c_session.hpp"
+#include "monitor_out.hpp"
+#include "serial_formatter.hpp"
+// the probe pipeline: bus scanning, serial capture
+// and formatting of the probe display text. This
+// is hardware independent so it can run on the host
+
+// serial data
+extern const int serial_bauds[];
+extern const size_t serial_bauds_size;
+// the settings. The buttons change these on the
+// render core while the probe thread reads them
+extern std::atomic<size_t> serial_baud_index;
+extern std::atomic_bool serial_bin;
+extern bool is_serial;
+// serial bytes consumed so far
+extern size_t serial_received;
+
+// probe display data
+extern char* display_text;
+extern size_t display_text_capacity;
+// the formatted serial display. Reports which
+// rows changed since it was last shown
+extern serial_formatter serial_view;
+// the serial monitor echo
+extern monitor_out probe_monitor;
+// the bus the i2c scans use. It stays installed
+// between sweeps
+extern i2c_session probe_i2c_session;
+
+// allocate the display and serial buffers.
+// call after ui_init() computes the probe size
+bool probe_init();
+// called from a sweep as soon as an address answers
+typedef void (*probe_i2c_found_callback)(uint8_t address, void* state);
+// scan the i2c bus, setting the bit in banks[4]
+// for each address that responds. Reports false if
+// the bus couldn't be opened or failed part way. Then
+// banks[4] only holds what answered before that
+bool probe_scan_i2c(uint32_t* banks, probe_i2c_found_callback found = nullptr, void* state = nullptr);
+// the same with a Wire transmission per address and
+// no timeout. The host uses it, and on the device
+// it's kept to compare against (I2C_SCAN_BENCH)
+bool probe_scan_i2c_wire(uint32_t* banks, probe_i2c_found_callback found = nullptr, void* state = nullptr);
+// probe just the addresses set in addresses[4], setting
+// or clearing their bits in banks[4]. Other bits are kept.
+// Reports false, leaving banks[4] as it was, if any of
+// them got neither an ACK nor a NACK
+bool probe_poll_i2c(const uint32_t* addresses, uint32_t* banks);
+// format banks[4] if the i2c address list has
+// changed, echoing it and reporting true if so
+bool probe_refresh_i2c(const uint32_t* banks);
+// applies a single address coming or going to the
+// list, reformatting only the rows from its row on.
+// Reports true if the list changed. It isn't echoed
+bool probe_apply_i2c(uint8_t address, bool present);
+// echo the address list to the serial monitor
+void probe_echo_i2c();
+// check if there is serial data incoming, and
+// format and echo it if there is. reports true
+// if the serial display changed
+bool probe_refresh_serial();
+// the refresh functions don't touch display_text
+// so the view can be held while they keep running.
+// these copy the latest i2c or serial display into it
+void probe_show_i2c();
+void probe_show_serial();
@@ -0,0 +1,143 @@
+#pragma once
+#include <stddef.h>
+#include <stdlib.h>
+
+#include <atomic>
+// a single producer/single consumer ring buffer
+// with a power of two capacity. The head and tail
+// are free running counts masked into the buffer
+// so data never moves once it has been written
+template <typename T>
+class ring_buffer {
+    T* m_data;
+    size_t m_mask;
+    std::atomic<size_t> m_head;
+    std::atomic<size_t> m_tail;
+    ring_buffer(const ring_buffer& rhs) = delete;
+    ring_buffer& operator=(const ring_buffer& rhs) = delete;
+public:
+    ring_buffer() : m_data(nullptr), m_mask(0), m_head(0), m_tail(0) {
+    }
+    ~ring_buffer() {
+        deinitialize();
+    }
+    // allocates room for at least capacity items
+    // rounding up to the next power of two
+    bool initialize(size_t capacity) {
+        deinitialize();
+        size_t cap = 1;
+        while (cap < capacity) {
+            cap <<= 1;
+        }
+        m_data = (T*)malloc(cap * sizeof(T));
+        if (m_data == nullptr) {
+            return false;
+        }
+        m_mask = cap - 1;
+        m_head = 0;
+        m_tail = 0;
+        return true;
+    }
+    void deinitialize() {
+        if (m_data != nullptr) {
+            free(m_data);
+            m_data = nullptr;
+        }
+        m_mask = 0;
+        m_head = 0;
+        m_tail = 0;
+    }
+    bool initialized() const {
+        return m_data != nullptr;
+    }
+    size_t capacity() const {
+        return m_data != nullptr ? m_mask + 1 : 0;
+    }
+    // the number of items waiting to be read
+    size_t size() const {
+        return m_head.load(std::memory_order_acquire) -
+               m_tail.load(std::memory_order_acquire);
+    }
+    // the number of items that can be written
+    size_t available() const {
+        return capacity() - size();
+    }
+    bool empty() const {
+        return size() == 0;
+    }
+    // producer: retrieves the contiguous free
+    // space at the head, and its length
+    T* write_span(size_t* out_count) {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        const size_t tail = m_tail.load(std::memory_order_acquire);
+        const size_t idx = head & m_mask;
+        const size_t free = capacity() - (head - tail);
+        const size_t to_end = capacity() - idx;
+        *out_count = free < to_end ? free : to_end;
+        return m_data + idx;
+    }
+    // producer: publishes count items written
+    // into the span from write_span()
+    void commit(size_t count) {
+        m_head.store(m_head.load(std::memory_order_relaxed) + count,
+                     std::memory_order_release);
+    }
+    // producer: copies in as much of data as fits
+    // returning the number of items written
+    size_t write(const T* data, size_t count) {
+        size_t written = 0;
+        while (written < count) {
+            size_t span;
+            T* p = write_span(&span);
+            if (span == 0) {
+                break;
+            }
+            if (span > count - written) {
+                span = count - written;
+            }
+            for (size_t i = 0; i < span; ++i) {
+                p[i] = data[written + i];
+            }
+            commit(span);
+            written += span;
+        }
+        return written;
+    }
+    // consumer: retrieves the buffered data, oldest
+    // first, as up to two contiguous spans. The
+    // second span is empty unless the data wraps.
+    // returns the total count
+    size_t peek(const T** out_span1,
+                size_t* out_count1,
+                const T** out_span2,
+                size_t* out_count2) const {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        const size_t count = m_head.load(std::memory_order_acquire) - tail;
+        const size_t idx = tail & m_mask;
+        const size_t to_end = capacity() - idx;
+        *out_span1 = m_data + idx;
+        *out_span2 = m_data;
+        if (count <= to_end) {
+            *out_count1 = count;
+            *out_count2 = 0;
+        } else {
+            *out_count1 = to_end;
+            *out_count2 = count - to_end;
+        }
+        return count;
+    }
+    // consumer: discards up to count of the oldest items
+    void consume(size_t count) {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        const size_t size = m_head.load(std::memory_order_acquire) - tail;
+        if (count > size) {
+            count = size;
+        }
+        m_tail.store(tail + count, std::memory_order_release);
+    }
+    // consumer: discards everything
+    void clear() {
+        m_tail.store(m_head.load(std::memory_order_acquire),
+                     std::memory_order_release);
+    }
+};
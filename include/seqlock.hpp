@@ -0,0 +1,69 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <atomic>
+#include <type_traits>
+// shares a small value from one writer to any number of
+// readers without locks. The sequence is odd while a write
+// is under way. Readers copy the value and try again if the
+// sequence moved while they did, so the writer never waits.
+// A reader can only be held up by a write in progress, so
+// it mustn't be able to preempt the writer on its own core
+template <typename T>
+class seqlock {
+    static_assert(std::is_trivially_copyable<T>::value, "T must be trivially copyable");
+    static_assert(sizeof(T) % sizeof(uint32_t) == 0, "T must be a whole number of words");
+    static constexpr const size_t words = sizeof(T) / sizeof(uint32_t);
+    std::atomic<uint32_t> m_sequence;
+    // the value is held as words so a read that
+    // overlaps a write is a retry, not a data race
+    std::atomic<uint32_t> m_words[words];
+    seqlock(const seqlock& rhs) = delete;
+    seqlock& operator=(const seqlock& rhs) = delete;
+public:
+    seqlock() : m_sequence(0) {
+        for (size_t i = 0; i < words; ++i) {
+            m_words[i].store(0, std::memory_order_relaxed);
+        }
+    }
+    // writer side. only one thread may write
+    void write(const T& value) {
+        uint32_t copy[words];
+        memcpy(copy, &value, sizeof(T));
+        const uint32_t sequence = m_sequence.load(std::memory_order_relaxed);
+        m_sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < words; ++i) {
+            m_words[i].store(copy[i], std::memory_order_relaxed);
+        }
+        m_sequence.store(sequence + 2, std::memory_order_release);
+    }
+    // the number of writes so far. A reader can
+    // check this alone to see if anything changed
+    uint32_t generation() const {
+        return m_sequence.load(std::memory_order_acquire) >> 1;
+    }
+    // copies out the value, returning the
+    // generation it was written in
+    uint32_t read(T* out_value) const {
+        uint32_t copy[words];
+        uint32_t sequence;
+        while (true) {
+            sequence = m_sequence.load(std::memory_order_acquire);
+            if (sequence & 1) {
+                continue;
+            }
+            for (size_t i = 0; i < words; ++i) {
+                copy[i] = m_words[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (m_sequence.load(std::memory_order_relaxed) == sequence) {
+                break;
+            }
+        }
+        memcpy(out_value, copy, sizeof(T));
+        return sequence >> 1;
+    }
+};
@@ -0,0 +1,47 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ring_buffer.hpp"
+// captures the serial probe on a dedicated task.
+// On the ESP32 the task is woken by the UART driver's
+// event queue (RX FIFO full and RX timeout) and
+// drains the bytes into the capture buffer as soon
+// as they arrive, so a busy render loop can't
+// overflow the FIFO. The display side reads the
+// buffer on its own schedule
+
+// the default capture buffer size. At 921600 baud
+// this holds ~170ms of data
+#ifndef SERIAL_CAPTURE_SIZE
+#define SERIAL_CAPTURE_SIZE 16384
+#endif
+
+// serial capture loss counters
+typedef struct serial_capture_stats {
+    // bytes moved into the capture buffer
+    size_t received;
+    // times the hardware FIFO or driver buffer overflowed
+    size_t overflows;
+    // bytes lost in the hardware FIFO. On the ESP32
+    // this is an upper bound (a full FIFO per overflow)
+    size_t overflowed;
+    // bytes dropped because the capture buffer was full
+    size_t dropped;
+    // time the capture task has spent draining, in
+    // microseconds. It wraps after ~71 minutes
+    uint32_t busy_us;
+} serial_capture_stats_t;
+
+// installs the UART driver and starts the capture task.
+// capacity is rounded up to a power of two
+bool serial_capture_begin(int baud, size_t capacity);
+// stops the capture task and releases the UART
+void serial_capture_end();
+// changes the baud rate of the probe
+void serial_capture_baud(int baud);
+// the captured data. The capture task is the only
+// producer. The caller is the only consumer
+ring_buffer<uint8_t>& serial_capture_buffer();
+// retrieves the loss counters
+void serial_capture_statistics(serial_capture_stats_t* out_stats);
@@ -0,0 +1,64 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+// formats serial data into a grid of text rows
+// incrementally. Only newly arrived bytes are
+// formatted, and when the grid is full the top
+// row is dropped. Rows are kept in a ring so
+// scrolling never moves any text
+class serial_formatter {
+    char* m_data;
+    uint16_t* m_lengths;
+    uint16_t m_cols;
+    uint16_t m_rows;
+    // the physical index of the top row
+    uint16_t m_top;
+    // the number of rows in use
+    uint16_t m_count;
+    // the cell cursor in the bottom row
+    uint16_t m_cursor;
+    bool m_binary;
+    // changes since the last call to clean()
+    int m_dirty_first;
+    int m_dirty_last;
+    size_t m_scrolled;
+    serial_formatter(const serial_formatter& rhs) = delete;
+    serial_formatter& operator=(const serial_formatter& rhs) = delete;
+    // the number of bytes that fit on a row
+    uint16_t cells() const;
+    // starts a new row at the bottom, scrolling if necessary
+    void new_row();
+    void dirty(int row);
+public:
+    serial_formatter();
+    ~serial_formatter();
+    // allocates the grid
+    bool initialize(uint16_t cols, uint16_t rows);
+    void deinitialize();
+    uint16_t cols() const;
+    uint16_t rows() const;
+    // true if bytes are displayed as hex
+    bool binary() const;
+    // sets the display mode, clearing the grid if it changed
+    void binary(bool value);
+    // clears the grid
+    void clear();
+    // formats size bytes onto the end of the grid
+    void write(const uint8_t* data, size_t size);
+    // the number of rows in use
+    uint16_t count() const;
+    // retrieves a row by its position on the display
+    const char* row(uint16_t index, uint16_t* out_length) const;
+    // reports the range of rows that changed
+    // since the last clean(), if any
+    bool dirty(uint16_t* out_first, uint16_t* out_last) const;
+    // the number of rows scrolled off the top
+    // since the last clean()
+    size_t scrolled() const;
+    // resets the change tracking
+    void clean();
+    // writes the grid out as newline separated text,
+    // returning the length. capacity must allow for
+    // cols()*rows() characters plus newlines and a null
+    size_t text(char* out_text, size_t capacity) const;
+};
@@ -0,0 +1,55 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+// hands the latest of a series of values from one producer
+// to one consumer without locks. The producer fills back()
+// and publishes it. The consumer takes the newest published
+// value into front(). Neither side ever waits on the other,
+// and values the consumer doesn't get to in time are skipped
+template <typename T>
+class triple_buffer {
+    // set on the middle slot when it
+    // holds a value not yet taken
+    static constexpr const uint8_t fresh = 4;
+    T m_slots[3];
+    std::atomic<uint8_t> m_middle;
+    uint8_t m_back;
+    uint8_t m_front;
+    triple_buffer(const triple_buffer& rhs) = delete;
+    triple_buffer& operator=(const triple_buffer& rhs) = delete;
+public:
+    triple_buffer() : m_middle(1), m_back(0), m_front(2) {
+    }
+    // the slots by index, for setting them
+    // up before either side starts
+    T& slot(size_t index) {
+        return m_slots[index];
+    }
+    // producer side. the slot to fill next
+    T& back() {
+        return m_slots[m_back];
+    }
+    // hands back() to the consumer
+    void publish() {
+        m_back = m_middle.exchange(m_back | fresh) & 3;
+    }
+    // true if the last value published
+    // hasn't been taken yet
+    bool pending() const {
+        return (m_middle.load() & fresh) != 0;
+    }
+    // consumer side. moves the newest value into
+    // front(), reporting false if there wasn't one
+    bool take() {
+        if (!(m_middle.load() & fresh)) {
+            return false;
+        }
+        m_front = m_middle.exchange(m_front) & 3;
+        return true;
+    }
+    T& front() {
+        return m_slots[m_front];
+    }
+};
@@ -1,23 +1,278 @@
 #pragma once
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include "lcd_config.h"
 #include <gfx.hpp>
 #include <uix.hpp>
+#include "glyph_cache.hpp"
+#include "packed_font.hpp"
+// FRAME_STATS_OVERLAY shows the frame stats on screen,
+// so they have to be collected
+#if defined(FRAME_STATS_OVERLAY) && !defined(FRAME_STATS)
+#define FRAME_STATS
+#endif
+// the probe font glyph cache budget in bytes
+#ifndef PROBE_FONT_CACHE_SIZE
+#define PROBE_FONT_CACHE_SIZE (24*1024)
+#endif
+#ifdef LCD_DIRECT_RENDER
+// a screen that renders into a frame buffer rather than
+// into strips sent to the panel. Dirty rectangles are widened
+// to whole rows, so each is a contiguous band of the frame
+// buffer. A band is composed a few rows at a time in a
+// scratch buffer and copied in, so the panel never scans
+// out a cleared band. The flush callback is handed each
+// band once it's copied, with a pointer to its first row
+template<typename PixelType>
+class direct_screen : public uix::invalidation_tracker {
+public:
+    using type = direct_screen;
+    using pixel_type = PixelType;
+    using bitmap_type = gfx::bitmap<pixel_type>;
+    using control_surface_type = uix::control_surface<bitmap_type>;
+    using control_type = uix::control<control_surface_type>;
+    typedef void (*on_flush_callback_type)(const gfx::rect16& bounds, const void* bmp, void* state);
+private:
+    static constexpr const size_t max_controls = 16;
+    static constexpr const size_t max_bands = 8;
+    gfx::size16 m_dimensions;
+    uint8_t* m_frame_buffer;
+    uint8_t* m_buffer;
+    size_t m_buffer_size;
+    control_type* m_controls[max_controls];
+    size_t m_controls_size;
+    // dirty row ranges, y1 to y2 inclusive
+    int16_t m_bands[max_bands][2];
+    size_t m_bands_size;
+    pixel_type m_background_color;
+    on_flush_callback_type m_on_flush_callback;
+    void* m_on_flush_callback_state;
+    size_t stride() const {
+        return bitmap_type::sizeof_buffer(gfx::size16(m_dimensions.width, 1));
+    }
+    void add_band(int16_t y1, int16_t y2) {
+        // fold in any bands it touches
+        size_t i = 0;
+        while (i < m_bands_size) {
+            if (y1 <= m_bands[i][1] + 1 && y2 + 1 >= m_bands[i][0]) {
+                y1 = y1 < m_bands[i][0] ? y1 : m_bands[i][0];
+                y2 = y2 > m_bands[i][1] ? y2 : m_bands[i][1];
+                m_bands[i][0] = m_bands[m_bands_size - 1][0];
+                m_bands[i][1] = m_bands[m_bands_size - 1][1];
+                --m_bands_size;
+                i = 0;
+                continue;
+            }
+            ++i;
+        }
+        if (m_bands_size == max_bands) {
+            // out of room. Merge with the last one
+            --m_bands_size;
+            y1 = y1 < m_bands[m_bands_size][0] ? y1 : m_bands[m_bands_size][0];
+            y2 = y2 > m_bands[m_bands_size][1] ? y2 : m_bands[m_bands_size][1];
+        }
+        m_bands[m_bands_size][0] = y1;
+        m_bands[m_bands_size][1] = y2;
+        ++m_bands_size;
+    }
+public:
+    direct_screen() : m_dimensions(0, 0), m_frame_buffer(nullptr), m_buffer(nullptr), m_buffer_size(0), m_controls_size(0), m_bands_size(0), m_background_color(), m_on_flush_callback(nullptr), m_on_flush_callback_state(nullptr) {
+    }
+    gfx::size16 dimensions() const {
+        return m_dimensions;
+    }
+    void dimensions(gfx::size16 value) {
+        m_dimensions = value;
+        invalidate();
+    }
+    gfx::srect16 bounds() const {
+        return gfx::srect16(gfx::spoint16::zero(), (gfx::ssize16)m_dimensions);
+    }
+    // the frame buffer, whose rows must be
+    // exactly the screen's width apart
+    uint8_t* frame_buffer() const {
+        return m_frame_buffer;
+    }
+    void frame_buffer(uint8_t* value) {
+        m_frame_buffer = value;
+        invalidate();
+    }
+    // the scratch buffer bands are composed in. It
+    // must hold at least one row
+    uint8_t* buffer() const {
+        return m_buffer;
+    }
+    size_t buffer_size() const {
+        return m_buffer_size;
+    }
+    void buffer(uint8_t* value, size_t size) {
+        m_buffer = value;
+        m_buffer_size = size;
+    }
+    pixel_type background_color() const {
+        return m_background_color;
+    }
+    void background_color(pixel_type value) {
+        m_background_color = value;
+        invalidate();
+    }
+    void on_flush_callback(on_flush_callback_type callback, void* state = nullptr) {
+        m_on_flush_callback = callback;
+        m_on_flush_callback_state = state;
+    }
+    gfx::gfx_result register_control(control_type& control) {
+        if (m_controls_size == max_controls) {
+            return gfx::gfx_result::out_of_memory;
+        }
+        m_controls[m_controls_size++] = &control;
+        control.parent(*this);
+        return invalidate(control.bounds());
+    }
+    gfx::gfx_result invalidate() {
+        return invalidate(bounds());
+    }
+    virtual gfx::gfx_result invalidate(const gfx::srect16& rect) {
+        if (!rect.intersects(bounds())) {
+            return gfx::gfx_result::success;
+        }
+        const gfx::srect16 r = rect.crop(bounds());
+        add_band(r.y1, r.y2);
+        return gfx::gfx_result::success;
+    }
+    // paints the dirty bands into the frame buffer
+    gfx::gfx_result update() {
+        const size_t rows = m_buffer_size / stride();
+        if (m_frame_buffer == nullptr || m_buffer == nullptr || rows == 0) {
+            return gfx::gfx_result::invalid_state;
+        }
+        for (size_t i = 0; i < m_bands_size; ++i) {
+            const int16_t y1 = m_bands[i][0];
+            const int16_t y2 = m_bands[i][1];
+            for (int16_t y = y1; y <= y2; y += rows) {
+                const int16_t h = (y2 - y + 1) < (int16_t)rows ? (y2 - y + 1) : (int16_t)rows;
+                const gfx::srect16 part(0, y, m_dimensions.width - 1, y + h - 1);
+                bitmap_type bmp(gfx::size16(m_dimensions.width, h), m_buffer);
+                bmp.fill(bmp.bounds(), m_background_color);
+                for (size_t j = 0; j < m_controls_size; ++j) {
+                    control_type& ctl = *m_controls[j];
+                    if (!ctl.visible() || !ctl.bounds().intersects(part)) {
+                        continue;
+                    }
+                    const gfx::srect16 cb = ctl.bounds();
+                    control_surface_type surface(bmp, cb.offset(0, -y));
+                    ctl.on_before_paint();
+                    ctl.on_paint(surface, cb.crop(part).offset(-cb.x1, -cb.y1));
+                }
+                memcpy(m_frame_buffer + stride() * y, m_buffer, stride() * h);
+            }
+            if (m_on_flush_callback != nullptr) {
+                const gfx::rect16 band(0, y1, m_dimensions.width - 1, y2);
+                m_on_flush_callback(band, m_frame_buffer + stride() * y1, m_on_flush_callback_state);
+            }
+        }
+        m_bands_size = 0;
+        return gfx::gfx_result::success;
+    }
+};
+#endif
 // user interface controls
 // and screen declarations
+#ifdef LCD_DIRECT_RENDER
+using ui_screen_t = direct_screen<gfx::rgb_pixel<LCD_BIT_DEPTH>>;
+#else
 using ui_screen_t = uix::screen<gfx::rgb_pixel<LCD_BIT_DEPTH>>;
+#endif
 using ui_label_t = uix::label<typename ui_screen_t::control_surface_type>;
 using ui_painter_t = uix::painter<typename ui_screen_t::control_surface_type>;
 
+// displays an SVG. The SVG is rasterized once into a
+// cached bitmap in the screen's pixel format, blended over
+// the matte colour, which should be the colour under the
+// control. A mask with a bit per pixel marks the pixels the
+// SVG covers, so only those are drawn on later paints. It's
+// only rendered again when the stream, size or matte
+// changes. If the cache can't be allocated that's logged,
+// and it renders every paint instead
 template<typename ControlSurfaceType>
-class svg_box : public uix::canvas_control<ControlSurfaceType> {
-    using base_type = uix::canvas_control<ControlSurfaceType>;
+class svg_box : public uix::control<ControlSurfaceType> {
+    using base_type = uix::control<ControlSurfaceType>;
+    using pixel_type = typename ControlSurfaceType::pixel_type;
+    using cache_type = gfx::bitmap<pixel_type>;
     gfx::stream* m_stream;
     gfx::matrix m_transform;
+    gfx::rgba_pixel<32> m_matte;
     bool m_dirty;
+    gfx::size16 m_cache_size;
+    void* m_cache_buffer;
+    bool m_cache_valid;
+    bool m_cache_failed;
+    size_t mask_stride() const {
+        return (m_cache_size.width + 7) / 8;
+    }
+    uint8_t* mask() const {
+        return (uint8_t*)m_cache_buffer + cache_type::sizeof_buffer(m_cache_size);
+    }
+    void release_cache() {
+        if(m_cache_buffer!=nullptr) {
+            free(m_cache_buffer);
+            m_cache_buffer = nullptr;
+        }
+        m_cache_valid = false;
+        m_cache_failed = false;
+    }
+    template<typename Destination>
+    gfx::gfx_result render(Destination& destination) {
+        gfx::canvas cv((gfx::size16)destination.dimensions());
+        gfx::gfx_result res = gfx::draw::canvas(destination,cv);
+        if(res!=gfx::gfx_result::success) {
+            return res;
+        }
+        m_stream->seek(0);
+        res = cv.render_svg(*m_stream,m_transform);
+        cv.deinitialize();
+        return res;
+    }
+    // renders over a solid colour, marking the pixels
+    // that came out different from it in the mask
+    bool render_mask(cache_type& cache, gfx::rgba_pixel<32> fill) {
+        gfx::draw::filled_rectangle(cache,cache.bounds(),fill);
+        pixel_type fill_px;
+        cache.point(gfx::point16(0,0),&fill_px);
+        if(gfx::gfx_result::success!=render(cache)) {
+            return false;
+        }
+        uint8_t* row = mask();
+        for(uint16_t y = 0;y<m_cache_size.height;++y,row+=mask_stride()) {
+            for(uint16_t x = 0;x<m_cache_size.width;++x) {
+                pixel_type px;
+                cache.point(gfx::point16(x,y),&px);
+                if(px.native_value!=fill_px.native_value) {
+                    row[x/8] |= (uint8_t)(0x80>>(x&7));
+                }
+            }
+        }
+        return true;
+    }
+    bool render_cache() {
+        cache_type cache(m_cache_size,m_cache_buffer);
+        memset(mask(),0,mask_stride()*m_cache_size.height);
+        // anything the SVG covers comes out different
+        // over black or over white, even if it's one of them
+        if(!render_mask(cache,gfx::rgba_pixel<32>(0,0,0,255)) ||
+                !render_mask(cache,gfx::rgba_pixel<32>(255,255,255,255))) {
+            return false;
+        }
+        gfx::draw::filled_rectangle(cache,cache.bounds(),m_matte);
+        return gfx::gfx_result::success==render(cache);
+    }
 public:
     using control_surface_type = ControlSurfaceType;
-    svg_box() : base_type(), m_stream(nullptr),m_dirty(true) {
+    svg_box() : base_type(), m_stream(nullptr),m_matte(255,255,255,255),m_dirty(true),m_cache_size(0,0),m_cache_buffer(nullptr),m_cache_valid(false),m_cache_failed(false) {
 
+    }
+    virtual ~svg_box() {
+        release_cache();
     }
     gfx::stream& stream() const {
         return *m_stream;
@@ -27,41 +282,394 @@ public:
         m_dirty = true;
         this->invalidate();
     }
+    // the colour under the control, which the
+    // cached image's edges are blended over
+    gfx::rgba_pixel<32> matte() const {
+        return m_matte;
+    }
+    void matte(gfx::rgba_pixel<32> value) {
+        m_matte = value;
+        m_cache_valid = false;
+        this->invalidate();
+    }
+    // the bytes the cache takes at the current size,
+    // allocated on the first paint
+    size_t cache_bytes() const {
+        if(m_stream==nullptr) {
+            return 0;
+        }
+        const gfx::size16 size = (gfx::size16)this->bounds().dimensions();
+        return cache_type::sizeof_buffer(size)+(size.width+7)/8*size.height;
+    }
 protected:
     virtual void on_before_paint() override {
-        if(m_stream!=nullptr && m_dirty) {
+        if(m_stream==nullptr) {
+            return;
+        }
+        const gfx::size16 size = (gfx::size16)this->bounds().dimensions();
+        // a new size needs a new transform
+        if(size.width!=m_cache_size.width || size.height!=m_cache_size.height) {
+            release_cache();
+            m_cache_size = size;
+            m_dirty = true;
+        }
+        if(m_dirty) {
             m_stream->seek(0);
             gfx::sizef dim;
             if(gfx::gfx_result::success == gfx::canvas::svg_dimensions(*m_stream,&dim)) {
                 m_transform = gfx::matrix::create_fit_to(dim,(gfx::rectf)this->bounds());
                 m_dirty = false;
+                m_cache_valid = false;
+            }
+        }
+        if(!m_dirty && !m_cache_valid && !m_cache_failed) {
+            if(m_cache_buffer==nullptr) {
+                const size_t cache_size = cache_bytes();
+                m_cache_buffer = malloc(cache_size);
+                if(m_cache_buffer==nullptr) {
+                    // don't try again until the size changes
+                    m_cache_failed = true;
+                    printf("Could not allocate the %ux%u SVG cache (%u bytes). Rendering every paint\n",
+                        (unsigned)size.width,
+                        (unsigned)size.height,
+                        (unsigned)cache_size);
+                    return;
+                }
             }
-        
+            m_cache_valid = render_cache();
         }
     }
-    virtual void on_paint(gfx::canvas& destination, const uix::srect16& clip) override {
-        if(m_stream!=nullptr) {
-            m_stream->seek(0);
-            destination.render_svg(*m_stream,m_transform);
+    virtual void on_paint(control_surface_type& destination, const uix::srect16& clip) override {
+        if(m_stream==nullptr) {
+            return;
+        }
+        if(!m_cache_valid) {
+            render(destination);
+            return;
+        }
+        // copy the runs of covered pixels in each row
+        cache_type cache(m_cache_size,m_cache_buffer);
+        const int y1 = clip.y1>0?clip.y1:0;
+        const int y2 = clip.y2<m_cache_size.height-1?clip.y2:m_cache_size.height-1;
+        const int x1 = clip.x1>0?clip.x1:0;
+        const int x2 = clip.x2<m_cache_size.width-1?clip.x2:m_cache_size.width-1;
+        for(int y = y1;y<=y2;++y) {
+            const uint8_t* row = mask()+mask_stride()*y;
+            int x = x1;
+            while(x<=x2) {
+                while(x<=x2 && !(row[x/8]&(0x80>>(x&7)))) {
+                    ++x;
+                }
+                const int run = x;
+                while(x<=x2 && (row[x/8]&(0x80>>(x&7)))) {
+                    ++x;
+                }
+                if(x>run) {
+                    const gfx::rect16 src(run,y,x-1,y);
+                    gfx::draw::bitmap(destination,(gfx::srect16)src,cache,src);
+                }
+            }
+        }
+    }
+};
+
+// displays an image pre-rendered at build time.
+// Rows are decoded and blended one at a time
+template<typename ControlSurfaceType>
+class packed_image_box : public uix::control<ControlSurfaceType> {
+    using base_type = uix::control<ControlSurfaceType>;
+    using row_type = gfx::bitmap<gfx::rgba_pixel<32>>;
+    const packed_image_data_t* m_image;
+public:
+    using control_surface_type = ControlSurfaceType;
+    packed_image_box() : base_type(), m_image(nullptr) {
+
+    }
+    const packed_image_data_t& image() const {
+        return *m_image;
+    }
+    void image(const packed_image_data_t& image) {
+        m_image = &image;
+        this->invalidate();
+    }
+    // nothing is cached
+    size_t cache_bytes() const {
+        return 0;
+    }
+protected:
+    virtual void on_paint(control_surface_type& destination, const uix::srect16& clip) override {
+        uint32_t row[256];
+        if(m_image==nullptr || m_image->width>256) {
+            return;
+        }
+        const uint8_t* p = m_image->data;
+        for(int y = 0;y<m_image->height && y<=clip.y2;++y) {
+            p+=packed_decode(p,4,m_image->width,row);
+            if(y>=clip.y1) {
+                row_type bmp(gfx::size16(m_image->width,1),row);
+                gfx::draw::bitmap(destination,gfx::srect16(0,y,m_image->width-1,y),bmp,bmp.bounds());
+            }
+        }
+    }
+};
+
+// a character cell terminal. Holds a grid of code points,
+// each with a foreground colour from a small palette, and
+// paints them at fixed pitch: the cell size is measured
+// once when the font is set, with no layout or line
+// breaking when painting. Writing only invalidates the
+// rows whose cells changed
+template<typename ControlSurfaceType>
+class terminal : public uix::control<ControlSurfaceType> {
+    using base_type = uix::control<ControlSurfaceType>;
+public:
+    // the number of colours cells can have
+    constexpr static const size_t palette_size = 16;
+private:
+    struct cell {
+        uint16_t codepoint;
+        uint8_t color;
+    };
+    const gfx::font* m_font;
+    gfx::rgba_pixel<32> m_palette[palette_size];
+    size_t m_palette_count;
+    // the palette index new cells are written with
+    uint8_t m_color;
+    gfx::size16 m_padding;
+    gfx::size16 m_cell_size;
+    uint16_t m_cols;
+    uint16_t m_rows;
+    cell* m_cells;
+    terminal(const terminal& rhs) = delete;
+    terminal& operator=(const terminal& rhs) = delete;
+    cell* row_cells(uint16_t row) const {
+        return m_cells + (size_t)row * m_cols;
+    }
+    // the row's rectangle in control coordinates
+    gfx::srect16 row_bounds(uint16_t row) const {
+        const int y = m_padding.height + row * m_cell_size.height;
+        return gfx::srect16(0, y, this->bounds().width() - 1, y + m_cell_size.height - 1);
+    }
+    void invalidate_row(uint16_t row) {
+        this->invalidate(row_bounds(row).offset(this->bounds().x1, this->bounds().y1));
+    }
+    // sets a cell, invalidating its row if it changed
+    void set(uint16_t col, uint16_t row, uint16_t codepoint) {
+        cell& c = row_cells(row)[col];
+        if (c.codepoint != codepoint || (codepoint != ' ' && c.color != m_color)) {
+            c.codepoint = codepoint;
+            c.color = m_color;
+            if (m_font != nullptr) {
+                invalidate_row(row);
+            }
+        }
+    }
+public:
+    using control_surface_type = ControlSurfaceType;
+    terminal() : base_type(), m_font(nullptr), m_palette_count(1), m_color(0), m_padding(4, 4), m_cell_size(0, 0), m_cols(0), m_rows(0), m_cells(nullptr) {
+        m_palette[0] = gfx::rgba_pixel<32>(255, 255, 255, 255);
+    }
+    virtual ~terminal() {
+        deinitialize();
+    }
+    // allocates the grid
+    bool initialize(uint16_t cols, uint16_t rows) {
+        deinitialize();
+        m_cells = (cell*)malloc((size_t)rows * cols * sizeof(cell));
+        if (m_cells == nullptr) {
+            return false;
+        }
+        m_cols = cols;
+        m_rows = rows;
+        clear();
+        return true;
+    }
+    void deinitialize() {
+        if (m_cells != nullptr) {
+            free(m_cells);
+            m_cells = nullptr;
+        }
+        m_cols = 0;
+        m_rows = 0;
+    }
+    uint16_t cols() const {
+        return m_cols;
+    }
+    uint16_t rows() const {
+        return m_rows;
+    }
+    const gfx::font& font() const {
+        return *m_font;
+    }
+    // sets the font, which should be monospace.
+    // the cell size is the size of "M"
+    void font(const gfx::font& value) {
+        m_font = &value;
+        gfx::text_info ti;
+        ti.text_font = m_font;
+        ti.text_sz("M");
+        m_font->measure(-1, ti, &m_cell_size);
+        m_cell_size.height = m_font->line_height();
+        this->invalidate();
+    }
+    gfx::size16 cell_size() const {
+        return m_cell_size;
+    }
+    // the colour new cells are written with
+    gfx::rgba_pixel<32> color() const {
+        return m_palette[m_color];
+    }
+    // sets the colour new cells are written with. Once the
+    // palette is full an entry no drawn cell uses is reused.
+    // Returns false if every entry is in use
+    bool color(gfx::rgba_pixel<32> value) {
+        for (size_t i = 0; i < m_palette_count; ++i) {
+            if (m_palette[i] == value) {
+                m_color = (uint8_t)i;
+                return true;
+            }
+        }
+        if (m_palette_count < palette_size) {
+            m_color = (uint8_t)m_palette_count++;
+            m_palette[m_color] = value;
+            return true;
+        }
+        // blanks aren't drawn so their colour doesn't matter
+        uint16_t used = 0;
+        for (size_t i = 0; i < (size_t)m_cols * m_rows; ++i) {
+            if (m_cells[i].codepoint != ' ') {
+                used |= 1 << m_cells[i].color;
+            }
+        }
+        for (size_t i = 0; i < palette_size; ++i) {
+            if ((used & (1 << i)) == 0) {
+                m_color = (uint8_t)i;
+                m_palette[m_color] = value;
+                return true;
+            }
+        }
+        return false;
+    }
+    gfx::size16 padding() const {
+        return m_padding;
+    }
+    void padding(gfx::size16 value) {
+        m_padding = value;
+        this->invalidate();
+    }
+    // blanks every cell
+    void clear() {
+        for (size_t i = 0; i < (size_t)m_cols * m_rows; ++i) {
+            m_cells[i].codepoint = ' ';
+            m_cells[i].color = m_color;
+        }
+        this->invalidate();
+    }
+    // retrieves a cell's code point and colour
+    uint16_t codepoint(uint16_t col, uint16_t row) const {
+        return row_cells(row)[col].codepoint;
+    }
+    gfx::rgba_pixel<32> color(uint16_t col, uint16_t row) const {
+        return m_palette[row_cells(row)[col].color];
+    }
+    // writes a code point in the current colour
+    void put(uint16_t col, uint16_t row, uint16_t codepoint) {
+        if (col < m_cols && row < m_rows) {
+            set(col, row, codepoint);
+        }
+    }
+    // writes a row of text in the current colour,
+    // blanking the rest of the row
+    void write_row(uint16_t row, const char* text, size_t length) {
+        if (row >= m_rows) {
+            return;
+        }
+        if (length > m_cols) {
+            length = m_cols;
+        }
+        for (uint16_t c = 0; c < m_cols; ++c) {
+            set(c, row, c < length ? (uint8_t)text[c] : ' ');
+        }
+    }
+    // replaces the grid with text in the current colour,
+    // one row per line. Lines past the width are cut off
+    void text(const char* text) {
+        const char* sz = text;
+        for (uint16_t r = 0; r < m_rows; ++r) {
+            const char* eol = sz;
+            while (*eol && *eol != '\n') {
+                ++eol;
+            }
+            write_row(r, sz, eol - sz);
+            sz = *eol ? eol + 1 : eol;
+        }
+    }
+protected:
+    virtual void on_paint(control_surface_type& destination, const uix::srect16& clip) override {
+        if (m_font == nullptr || m_cells == nullptr) {
+            return;
+        }
+        char sz[2] = {0, 0};
+        gfx::text_info ti;
+        ti.text_font = m_font;
+        for (uint16_t r = 0; r < m_rows; ++r) {
+            const gfx::srect16 rb = row_bounds(r);
+            if (!rb.intersects(clip)) {
+                continue;
+            }
+            const cell* cells = row_cells(r);
+            int x = m_padding.width;
+            for (uint16_t c = 0; c < m_cols; ++c, x += m_cell_size.width) {
+                const cell& ce = cells[c];
+                if (ce.codepoint == ' ' || x > clip.x2 || x + m_cell_size.width <= clip.x1) {
+                    continue;
+                }
+                sz[0] = (char)ce.codepoint;
+                ti.text_sz(sz);
+                gfx::draw::text(destination,
+                                gfx::srect16(x, rb.y1, x + m_cell_size.width - 1, rb.y2),
+                                ti,
+                                m_palette[ce.color]);
+            }
         }
     }
 };
 
 using ui_svg_box_t = svg_box<typename ui_screen_t::control_surface_type>;
-extern gfx::tt_font title_font;
-extern gfx::tt_font probe_font;
+using ui_packed_image_box_t = packed_image_box<typename ui_screen_t::control_surface_type>;
+using ui_terminal_t = terminal<typename ui_screen_t::control_surface_type>;
+// with PACKED_ASSETS the fonts and the title image come
+// from tables generated at build time instead of being
+// parsed from the TTF and SVG at runtime
+#ifdef PACKED_ASSETS
+using ui_font_t = packed_font;
+using ui_title_image_t = ui_packed_image_box_t;
+#else
+using ui_font_t = gfx::tt_font;
+using ui_title_image_t = ui_svg_box_t;
+// the sources the packed assets are made from
+extern gfx::const_buffer_stream probe_stm;
+#endif
+extern ui_font_t title_font;
+extern ui_font_t probe_font;
+extern ui_font_t probe_msg_font;
+extern glyph_cache probe_font_cache;
 extern ui_screen_t main_screen;
 extern uint16_t probe_cols;
 extern uint16_t probe_rows;
 // main screen
 extern ui_label_t title_label;
-extern ui_svg_box_t title_svg;
+extern ui_title_image_t title_svg;
 // probe screen
 extern ui_painter_t probe_painter;
-extern ui_label_t probe_label;
+extern ui_terminal_t probe_label;
 extern ui_painter_t msg_painter;
 extern ui_label_t probe_msg_label1;
 extern ui_label_t probe_msg_label2;
+#ifdef FRAME_STATS_OVERLAY
+// the frame rate and latency overlay
+extern ui_label_t stats_label;
+#endif
 extern uint16_t probe_cols;
 extern uint16_t probe_rows;
 void ui_init();
\ No newline at end of file
@@ -0,0 +1,43 @@
+#include <frame_stats.hpp>
+#include <string.h>
+
+#include <algorithm>
+
+rolling_stat::rolling_stat() : m_count(0), m_next(0) {
+}
+void rolling_stat::add(uint32_t value) {
+    m_samples[m_next] = value;
+    if (++m_next == FRAME_STATS_WINDOW) {
+        m_next = 0;
+    }
+    if (m_count < FRAME_STATS_WINDOW) {
+        ++m_count;
+    }
+}
+void rolling_stat::clear() {
+    m_count = 0;
+    m_next = 0;
+}
+size_t rolling_stat::count() const {
+    return m_count;
+}
+uint32_t rolling_stat::percentile(int percent) const {
+    if (m_count == 0) {
+        return 0;
+    }
+    // sort a copy. The window is small and
+    // this is only done for reports
+    uint32_t sorted[FRAME_STATS_WINDOW];
+    memcpy(sorted, m_samples, m_count * sizeof(uint32_t));
+    std::sort(sorted, sorted + m_count);
+    return sorted[(m_count - 1) * percent / 100];
+}
+uint32_t rolling_stat::max() const {
+    uint32_t result = 0;
+    for (size_t i = 0; i < m_count; ++i) {
+        if (m_samples[i] > result) {
+            result = m_samples[i];
+        }
+    }
+    return result;
+}
@@ -0,0 +1,178 @@
+#include <glyph_cache.hpp>
+#include <stdlib.h>
+#include <string.h>
+using namespace gfx;
+
+glyph_cache::glyph_cache(font& font, size_t budget) : m_font(font),
+                                                      m_budget(budget),
+                                                      m_cell_size(0),
+                                                      m_cell_count(0),
+                                                      m_atlas(nullptr),
+                                                      m_cells(nullptr),
+                                                      m_tick(0),
+                                                      m_hits(0),
+                                                      m_misses(0),
+                                                      m_evictions(0) {
+    memset(m_ascii, 0xFF, sizeof(m_ascii));
+}
+glyph_cache::~glyph_cache() {
+    deinitialize();
+}
+gfx_result glyph_cache::initialize() {
+    if (initialized()) {
+        return gfx_result::success;
+    }
+    if (!m_font.initialized()) {
+        gfx_result res = m_font.initialize();
+        if (res != gfx_result::success) {
+            return res;
+        }
+    }
+    // a line high and as wide, which holds any
+    // glyph of a monospace font
+    m_cell_size = m_font.line_height();
+    size_t cell_bytes = (size_t)m_cell_size * m_cell_size;
+    m_cell_count = cell_bytes ? m_budget / cell_bytes : 0;
+    if (m_cell_count == 0) {
+        return gfx_result::invalid_argument;
+    }
+    m_atlas = (uint8_t*)malloc(m_cell_count * cell_bytes);
+    if (m_atlas == nullptr) {
+        return gfx_result::out_of_memory;
+    }
+    m_cells = (cell*)malloc(m_cell_count * sizeof(cell));
+    if (m_cells == nullptr) {
+        free(m_atlas);
+        m_atlas = nullptr;
+        return gfx_result::out_of_memory;
+    }
+    clear();
+    return gfx_result::success;
+}
+bool glyph_cache::initialized() const {
+    return m_atlas != nullptr;
+}
+void glyph_cache::deinitialize() {
+    if (m_atlas != nullptr) {
+        free(m_atlas);
+        m_atlas = nullptr;
+    }
+    if (m_cells != nullptr) {
+        free(m_cells);
+        m_cells = nullptr;
+    }
+    m_cell_count = 0;
+}
+uint16_t glyph_cache::line_height() const {
+    return m_font.line_height();
+}
+uint16_t glyph_cache::line_advance() const {
+    return m_font.line_advance();
+}
+uint16_t glyph_cache::base_line() const {
+    return m_font.base_line();
+}
+gfx_result glyph_cache::on_measure(int32_t codepoint1,
+                                   int32_t codepoint2,
+                                   font_glyph_info* out_glyph_info) const {
+    return m_font.on_measure(codepoint1, codepoint2, out_glyph_info);
+}
+int glyph_cache::find(int32_t codepoint) const {
+    if (codepoint >= 0 && codepoint < 128) {
+        return m_ascii[codepoint];
+    }
+    for (size_t i = 0; i < m_cell_count; ++i) {
+        if (m_cells[i].codepoint == codepoint) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+int glyph_cache::allocate(int32_t codepoint) const {
+    // take an empty cell, or the least recently used
+    size_t result = 0;
+    for (size_t i = 0; i < m_cell_count; ++i) {
+        if (m_cells[i].codepoint == -1) {
+            result = i;
+            break;
+        }
+        if (m_cells[i].used < m_cells[result].used) {
+            result = i;
+        }
+    }
+    cell& c = m_cells[result];
+    if (c.codepoint != -1) {
+        if (c.codepoint < 128) {
+            m_ascii[c.codepoint] = -1;
+        }
+        ++m_evictions;
+    }
+    c.codepoint = codepoint;
+    if (codepoint >= 0 && codepoint < 128) {
+        m_ascii[codepoint] = (int16_t)result;
+    }
+    return (int)result;
+}
+gfx_result glyph_cache::on_draw(bitmap<alpha_pixel<8>>& destination,
+                                int32_t codepoint,
+                                int32_t glyph_index) const {
+    // the caller sizes the destination to the glyph
+    const size16 dim = destination.dimensions();
+    if (!initialized() || dim.width > m_cell_size || dim.height > m_cell_size) {
+        return m_font.on_draw(destination, codepoint, glyph_index);
+    }
+    const size_t cell_bytes = (size_t)m_cell_size * m_cell_size;
+    int i = find(codepoint);
+    if (i != -1 && (m_cells[i].dimensions.width != dim.width ||
+                    m_cells[i].dimensions.height != dim.height)) {
+        // drawn at a different size. Shouldn't happen
+        // with one font, but don't guess
+        return m_font.on_draw(destination, codepoint, glyph_index);
+    }
+    uint8_t* p;
+    if (i == -1) {
+        ++m_misses;
+        i = allocate(codepoint);
+        p = m_atlas + cell_bytes * i;
+        // rasterize into the cell. Cells are packed
+        // at the glyph's width so they copy out whole
+        memset(p, 0, (size_t)dim.width * dim.height);
+        bitmap<alpha_pixel<8>> bmp(dim, p);
+        gfx_result res = m_font.on_draw(bmp, codepoint, glyph_index);
+        if (res != gfx_result::success) {
+            if (codepoint >= 0 && codepoint < 128) {
+                m_ascii[codepoint] = -1;
+            }
+            m_cells[i].codepoint = -1;
+            m_cells[i].used = 0;
+            return res;
+        }
+        m_cells[i].dimensions = dim;
+    } else {
+        ++m_hits;
+        p = m_atlas + cell_bytes * i;
+    }
+    m_cells[i].used = ++m_tick;
+    memcpy(destination.begin(), p, (size_t)dim.width * dim.height);
+    return gfx_result::success;
+}
+void glyph_cache::clear() {
+    memset(m_ascii, 0xFF, sizeof(m_ascii));
+    for (size_t i = 0; i < m_cell_count; ++i) {
+        m_cells[i].codepoint = -1;
+        m_cells[i].used = 0;
+    }
+    m_tick = 0;
+}
+size_t glyph_cache::capacity() const {
+    return m_cell_count;
+}
+size_t glyph_cache::hits() const {
+    return m_hits;
+}
+size_t glyph_cache::misses() const {
+    return m_misses;
+}
+size_t glyph_cache::evictions() const {
+    return m_evictions;
+}
@@ -0,0 +1,59 @@
+#include <hex_dump.hpp>
+#include <string.h>
+
+// builds the lookup tables at compile time
+struct hex_dump_tables {
+    // the two hex digits for each byte, in memory order
+    char pairs[256][2];
+    // "XX " for each byte, as a little endian word
+    uint32_t triples[256];
+    constexpr hex_dump_tables() : pairs(), triples() {
+        const char* digits = "0123456789ABCDEF";
+        for (int i = 0; i < 256; ++i) {
+            pairs[i][0] = digits[i >> 4];
+            pairs[i][1] = digits[i & 0xF];
+            triples[i] = uint32_t((uint8_t)digits[i >> 4]) |
+                         (uint32_t((uint8_t)digits[i & 0xF]) << 8) |
+                         (uint32_t(' ') << 16);
+        }
+    }
+};
+static constexpr const hex_dump_tables hex_tables;
+
+size_t hex_dump(const uint8_t* data, size_t size, char* out_text) {
+    char* sz = out_text;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    // 4 bytes in, 12 characters out as 3 words
+    while (size >= 4) {
+        const uint32_t t0 = hex_tables.triples[data[0]];
+        const uint32_t t1 = hex_tables.triples[data[1]];
+        const uint32_t t2 = hex_tables.triples[data[2]];
+        const uint32_t t3 = hex_tables.triples[data[3]];
+        const uint32_t words[3] = {
+            t0 | (t1 << 24),
+            (t1 >> 8) | (t2 << 16),
+            (t2 >> 16) | (t3 << 8)};
+        memcpy(sz, words, sizeof(words));
+        sz += sizeof(words);
+        data += 4;
+        size -= 4;
+    }
+#endif
+    while (size--) {
+        const char* pair = hex_tables.pairs[*data++];
+        *sz++ = pair[0];
+        *sz++ = pair[1];
+        *sz++ = ' ';
+    }
+    return sz - out_text;
+}
+size_t hex_dump_row(const uint8_t* data, size_t size, char* out_text) {
+    if (size == 0) {
+        return 0;
+    }
+    char* sz = out_text + hex_dump(data, size - 1, out_text);
+    const char* pair = hex_tables.pairs[data[size - 1]];
+    *sz++ = pair[0];
+    *sz++ = pair[1];
+    return sz - out_text;
+}
@@ -0,0 +1,186 @@
+#include <hal.hpp>
+#include <i2c_scanner.hpp>
+#include <probe.hpp>
+#include <string.h>
+
+i2c_scanner::i2c_scanner() : m_started(false),
+                             m_sweep_ms(I2C_SWEEP_MIN_MS),
+                             m_sweep_ts(0),
+                             m_poll_ts(0),
+                             m_sweeps(0),
+                             m_polls(0),
+                             m_changes(0),
+                             m_failures(0),
+                             m_busy_us(0),
+                             m_on_event(nullptr),
+                             m_on_event_state(nullptr) {
+    memset(m_banks, 0, sizeof(m_banks));
+    memset(m_watch, 0, sizeof(m_watch));
+}
+void i2c_scanner::watch(uint8_t address) {
+    if (address < 128) {
+        m_watch[address / 32] |= (1 << (address % 32));
+    }
+}
+void i2c_scanner::on_event_callback(i2c_event_callback callback, void* state) {
+    m_on_event = callback;
+    m_on_event_state = state;
+}
+void i2c_scanner::on_found(uint8_t address, void* state) {
+    i2c_scanner* scanner = (i2c_scanner*)state;
+    // m_banks still holds the last results
+    // while the sweep runs
+    if (scanner->m_on_event != nullptr &&
+        !(scanner->m_banks[address / 32] & (1 << (address % 32)))) {
+        const i2c_event_t event = {address, true, millis()};
+        scanner->m_on_event(event, scanner->m_on_event_state);
+    }
+}
+void i2c_scanner::emit(const uint32_t* old_banks, const uint32_t* mask, bool present, uint32_t now_ms) {
+    if (m_on_event == nullptr) {
+        return;
+    }
+    for (int b = 0; b < 4; ++b) {
+        uint32_t diff = (old_banks[b] ^ m_banks[b]) & mask[b] & (present ? m_banks[b] : old_banks[b]);
+        while (diff) {
+            const int bit = __builtin_ctz(diff);
+            const i2c_event_t event = {(uint8_t)(b * 32 + bit), present, now_ms};
+            m_on_event(event, m_on_event_state);
+            diff &= diff - 1;
+        }
+    }
+}
+bool i2c_scanner::changed(const uint32_t* old_banks, const uint32_t* mask, uint32_t since_ms) {
+    bool result = false;
+    for (int b = 0; b < 4; ++b) {
+        uint32_t diff = (old_banks[b] ^ m_banks[b]) & mask[b];
+        while (diff) {
+            // one sample per address that came or went
+            m_latency.add(since_ms);
+            diff &= diff - 1;
+            result = true;
+        }
+    }
+    return result;
+}
+bool i2c_scanner::update(uint32_t now_ms) {
+    uint32_t old_banks[4];
+    memcpy(old_banks, m_banks, sizeof(old_banks));
+    bool result = false;
+    if (m_sweeps == 0 || now_ms - m_sweep_ts >= m_sweep_ms) {
+        uint32_t ts = micros();
+        uint32_t banks[4];
+        const bool swept = probe_scan_i2c(banks, on_found, this);
+        m_busy_us += micros() - ts;
+        ++m_sweeps;
+        if (!swept) {
+            // it says nothing about the addresses it didn't
+            // get to. Keep the ones it already reported
+            ++m_failures;
+            for (int b = 0; b < 4; ++b) {
+                m_banks[b] |= banks[b];
+            }
+            result = memcmp(old_banks, m_banks, sizeof(old_banks)) != 0;
+        } else {
+            memcpy(m_banks, banks, sizeof(m_banks));
+            // the new addresses were reported as they answered
+            const uint32_t all[4] = {~0u, ~0u, ~0u, ~0u};
+            emit(old_banks, all, false, millis());
+            if (!m_started) {
+                m_started = true;
+                result = memcmp(old_banks, m_banks, sizeof(old_banks)) != 0;
+            } else {
+                // the known addresses were last probed by a poll,
+                // the rest by the last sweep
+                uint32_t known[4];
+                uint32_t unknown[4];
+                for (int b = 0; b < 4; ++b) {
+                    known[b] = old_banks[b] | m_watch[b];
+                    unknown[b] = ~known[b];
+                }
+                result = changed(old_banks, known, now_ms - m_poll_ts);
+                result = changed(old_banks, unknown, now_ms - m_sweep_ts) || result;
+                if (!result && m_sweep_ms < I2C_SWEEP_MAX_MS) {
+                    // the bus is settled. Back off
+                    m_sweep_ms *= 2;
+                    if (m_sweep_ms > I2C_SWEEP_MAX_MS) {
+                        m_sweep_ms = I2C_SWEEP_MAX_MS;
+                    }
+                }
+            }
+            m_poll_ts = now_ms;
+        }
+        m_sweep_ts = now_ms;
+    } else if (now_ms - m_poll_ts >= I2C_POLL_MS) {
+        uint32_t known[4];
+        bool any = false;
+        for (int b = 0; b < 4; ++b) {
+            known[b] = m_banks[b] | m_watch[b];
+            any = any || known[b] != 0;
+        }
+        if (any) {
+            uint32_t ts = micros();
+            const bool polled = probe_poll_i2c(known, m_banks);
+            m_busy_us += micros() - ts;
+            ++m_polls;
+            if (!polled) {
+                // the banks weren't touched
+                ++m_failures;
+            } else {
+                emit(old_banks, known, true, millis());
+                emit(old_banks, known, false, millis());
+                result = changed(old_banks, known, now_ms - m_poll_ts);
+            }
+            m_poll_ts = now_ms;
+        }
+    }
+    if (result) {
+        ++m_changes;
+        // more may follow, like the rest of a
+        // board that was just plugged in
+        m_sweep_ms = I2C_SWEEP_MIN_MS;
+    }
+    return result;
+}
+uint32_t i2c_scanner::next_ms(uint32_t now_ms) const {
+    if (m_sweeps == 0) {
+        return 0;
+    }
+    uint32_t sweep = now_ms - m_sweep_ts;
+    sweep = sweep < m_sweep_ms ? m_sweep_ms - sweep : 0;
+    // with nothing to poll only the sweep wakes it
+    uint32_t any = 0;
+    for (int b = 0; b < 4; ++b) {
+        any |= m_banks[b] | m_watch[b];
+    }
+    if (any == 0) {
+        return sweep;
+    }
+    uint32_t poll = now_ms - m_poll_ts;
+    poll = poll < I2C_POLL_MS ? I2C_POLL_MS - poll : 0;
+    return sweep < poll ? sweep : poll;
+}
+const uint32_t* i2c_scanner::banks() const {
+    return m_banks;
+}
+uint32_t i2c_scanner::sweep_ms() const {
+    return m_sweep_ms;
+}
+size_t i2c_scanner::sweeps() const {
+    return m_sweeps;
+}
+size_t i2c_scanner::polls() const {
+    return m_polls;
+}
+size_t i2c_scanner::changes() const {
+    return m_changes;
+}
+size_t i2c_scanner::failures() const {
+    return m_failures;
+}
+uint32_t i2c_scanner::busy_us() const {
+    return m_busy_us;
+}
+const rolling_stat& i2c_scanner::latency() const {
+    return m_latency;
+}
@@ -0,0 +1,83 @@
+#include <hal.hpp>
+#include <i2c_session.hpp>
+#ifdef ARDUINO
+#include "driver/i2c.h"
+#endif
+
+i2c_session::i2c_session() : m_sda(I2C_SDA),
+                             m_scl(I2C_SCL),
+                             m_freq(100000),
+                             m_open(false),
+                             m_reset(false),
+                             m_inits(0),
+                             m_errors(0),
+                             m_init_us(0),
+                             m_last_init_us(0),
+                             m_max_init_us(0) {
+}
+void i2c_session::settings(int sda, int scl, uint32_t freq) {
+    if (sda != m_sda || scl != m_scl || freq != m_freq) {
+        m_sda = sda;
+        m_scl = scl;
+        m_freq = freq;
+        m_reset = true;
+    }
+}
+uint32_t i2c_session::freq() const {
+    return m_freq;
+}
+bool i2c_session::open() {
+    if (m_open && !m_reset) {
+        return true;
+    }
+    uint32_t ts = micros();
+    close();
+#ifdef ARDUINO
+    if (!I2C.begin(m_sda, m_scl, m_freq)) {
+        return false;
+    }
+    // ensure pullups
+    i2c_set_pin(0, m_sda, m_scl, true, true, I2C_MODE_MASTER);
+#else
+    if (!I2C.begin(m_sda, m_scl)) {
+        return false;
+    }
+#endif
+    m_open = true;
+    m_reset = false;
+    m_last_init_us = micros() - ts;
+    m_init_us += m_last_init_us;
+    if (m_last_init_us > m_max_init_us) {
+        m_max_init_us = m_last_init_us;
+    }
+    ++m_inits;
+    return true;
+}
+void i2c_session::close() {
+    if (m_open) {
+        I2C.end();
+        m_open = false;
+    }
+}
+void i2c_session::error() {
+    ++m_errors;
+    m_reset = true;
+}
+bool i2c_session::is_open() const {
+    return m_open;
+}
+size_t i2c_session::inits() const {
+    return m_inits;
+}
+size_t i2c_session::errors() const {
+    return m_errors;
+}
+uint32_t i2c_session::init_us() const {
+    return m_init_us;
+}
+uint32_t i2c_session::last_init_us() const {
+    return m_last_init_us;
+}
+uint32_t i2c_session::max_init_us() const {
+    return m_max_init_us;
+}
@@ -1,16 +1,6 @@
-// where the serial monitor output
-// goes
-#define MONITOR Serial
-// the I2C probe connections
-#define I2C Wire
-#define I2C_SDA 21
-#define I2C_SCL 22
-// the serial probe connections
-#define SER Serial1
-#define SER_RX 17
-#include <Arduino.h>
+#include <hal.hpp>
 #include <SPIFFS.h>
-#include <Wire.h>
+#include <esp_heap_caps.h>
 
 #include <atomic>
 #include <button.hpp>
@@ -20,10 +10,15 @@
 #include <gfx.hpp>
 #include <uix.hpp>
 
-#include "driver/i2c.h"
 #include "lcd_config.h"
 #define LCD_IMPLEMENTATION
 #include "lcd_init.h"
+#include "frame_stats.hpp"
+#include "i2c_scanner.hpp"
+#include "probe.hpp"
+#include "seqlock.hpp"
+#include "serial_capture.hpp"
+#include "triple_buffer.hpp"
 #include "ui.hpp"
 using namespace arduino;
 using namespace gfx;
@@ -34,20 +29,30 @@ using namespace freertos;
 static void uix_on_flush(const rect16& bounds,
                          const void* bmp,
                          void* state);
+#ifndef LCD_DIRECT_RENDER
 // the ESP Panel API calls this when the bitmap has been sent
 static bool lcd_flush_ready(esp_lcd_panel_io_handle_t panel_io,
                             esp_lcd_panel_io_event_data_t* edata,
                             void* user_ctx);
+#endif
+#ifndef LCD_DIRECT_RENDER
+// sizes and allocates the display strip buffers
+// from what the heap has to offer
+static bool lcd_buffers_alloc();
+#endif
 // put the display controller and panel to sleep
 static void lcd_sleep();
 // wake up the display controller and panel
 static void lcd_wake();
-// check if the i2c address list has changed and
-// rebuild the list if it has
+// advance the panel sleep/wake transitions,
+// reporting true if the panel can be drawn to
+static bool lcd_ready();
+// apply the i2c changes the scanner has queued,
+// reporting true if the address list changed
 static bool refresh_i2c();
-// check if there is serial data incoming
-// rebuild the display if it has
-static bool refresh_serial();
+// queues each address coming or going
+// (runs on the i2c core)
+static void i2c_on_event(const i2c_event_t& event, void* state);
 // saves the settings
 static void save_settings();
 // click handler for button a
@@ -59,9 +64,22 @@ static void button_b_on_click(int clicks, void* state);
 // thread routine that scans the bus and
 // updates the i2c address list
 static void i2c_update_task(void* state);
+// thread routine that formats the probe output and
+// hands finished views to the render thread
+static void probe_task(void* state);
 // we have to handle our main logic on a separate thread outside
 // of loop() because arduino doesn't give loop() enough stack
 static void render_task(void* state);
+// runs a single frame of the main logic
+static void render_frame();
+#ifdef FRAME_STATS
+// call around main_screen.update()
+static void frame_stats_begin();
+static void frame_stats_end(uint32_t update_us);
+// reports the frame stats and the core
+// utilisation to the monitor and the overlay
+static void frame_stats_report();
+#endif
 
 using dimmer_t = lcd_miser<4>;
 using color16_t = color<rgb_pixel<16>>;
@@ -71,40 +89,195 @@ using button_b_raw_t = int_button<0, 10, true>;
 using button_t = multi_button;
 using screen_t = screen<rgb_pixel<LCD_BIT_DEPTH>>;
 
+// the target frame rate. Input is coalesced
+// into at most one display update per frame
+#ifndef RENDER_FPS
+#define RENDER_FPS 30
+#endif
+#ifndef RENDER_STACK_SIZE
+#define RENDER_STACK_SIZE (16 * 1024)
+#endif
+// the display strip limits in rows. Taller strips mean
+// fewer transfers, but past about half the screen the
+// per transfer overhead is already paid off
+#ifndef LCD_STRIP_MAX_HEIGHT
+#define LCD_STRIP_MAX_HEIGHT (LCD_HEIGHT / 2)
+#endif
+#ifndef LCD_STRIP_MIN_HEIGHT
+#define LCD_STRIP_MIN_HEIGHT 8
+#endif
+// internal heap the strips leave on top of what's known to
+// be allocated after them: the i2c, probe and render task
+// stacks and the title SVG cache. This covers the event
+// queue, the task control blocks and the system
+#ifndef LCD_STRIP_HEAP_RESERVE
+#define LCD_STRIP_HEAP_RESERVE (16 * 1024)
+#endif
+// the rows a direct render band is composed in at a time
+// before it's copied into the panel's frame buffer
+#ifndef LCD_DIRECT_SCRATCH_HEIGHT
+#define LCD_DIRECT_SCRATCH_HEIGHT 16
+#endif
+
+// how often the probe thread checks for input
+#ifndef PROBE_INTERVAL_MS
+#define PROBE_INTERVAL_MS 5
+#endif
+#ifndef PROBE_STACK_SIZE
+#define PROBE_STACK_SIZE (8 * 1024)
+#endif
+#ifndef I2C_STACK_SIZE
+#define I2C_STACK_SIZE (4 * 1024)
+#endif
+
+// render thread data
+static thread renderer;
+
+// probe thread data
+static thread prober;
+// a finished probe display, handed from
+// the probe thread to the render thread
+struct probe_view {
+    bool serial;
+    // when the scanner saw the oldest i2c change
+    // in the view, or 0 if there wasn't one
+    uint32_t i2c_ms;
+    char* text;
+};
+static triple_buffer<probe_view> probe_views;
+// when the scanner saw the oldest i2c change not yet
+// handed to the render thread, or 0 if there isn't one
+static uint32_t probe_i2c_ms = 0;
+// serial bytes the probe thread has consumed
+static std::atomic<size_t> probe_received(0);
+
 // i2c update thread data
 static thread i2c_updater;
-static SemaphoreHandle_t i2c_update_sync;
-static volatile std::atomic_bool i2c_updater_ran;
 
 // i2c address data
-static uint32_t i2c_addresses[4];
-static uint32_t i2c_addresses_old[4];
+struct i2c_snapshot {
+    uint32_t banks[4];
+};
+// the whole address list, published by the i2c thread
+// after each change. Its generation counts the changes
+static seqlock<i2c_snapshot> i2c_addresses;
+// each address coming or going, in the order the scanner
+// saw them, with the generation of the list it will be
+// published in. If the queue overflows the probe thread
+// starts over from i2c_addresses, and only applies the
+// events that came after it
+#ifndef I2C_EVENT_QUEUE_SIZE
+#define I2C_EVENT_QUEUE_SIZE 32
+#endif
+struct i2c_queued_event {
+    i2c_event_t event;
+    uint32_t generation;
+};
+static QueueHandle_t i2c_events;
+static std::atomic_bool i2c_events_lost(false);
+// set once the whole list is published after an overflow
+static std::atomic_bool i2c_resync(false);
+// polls the known addresses and sweeps for new ones.
+// Only the i2c thread touches it
+static i2c_scanner i2c_scan;
+#ifdef I2C_WATCH
+// addresses to poll from the start
+static const uint8_t i2c_watch[] = {I2C_WATCH};
+#endif
 
-// serial data
-static const int serial_bauds[] = {
-    115200,
-    19200,
-    9600,
-    2400};
-static const size_t serial_bauds_size = sizeof(serial_bauds) / sizeof(int);
-static size_t serial_baud_index = 0;
-static bool serial_bin = false;
+// serial message display timeout
 static uint32_t serial_msg_ts = 0;
-static bool is_serial = false;
-static uint8_t* serial_data = nullptr;
-static size_t serial_data_capacity = 0;
-static size_t serial_data_size = 0;
 
-// probe display data
-static char* display_text = nullptr;
-static size_t display_text_capacity = 0;
+// the view is held while a button is down but
+// the probes keep running underneath it
+enum struct view_change {
+    none = 0,
+    i2c,
+    serial
+};
+static bool view_paused = false;
+static size_t view_paused_received = 0;
+static char view_paused_msg[16];
 
 // lcd panel ops and dimmer data
-static constexpr const size_t lcd_buffer_size = gfx::bitmap<rgb_pixel<LCD_BIT_DEPTH>>::sizeof_buffer(LCD_WIDTH,LCD_HEIGHT/5);
+#ifndef LCD_DIRECT_RENDER
+// sized at startup by lcd_buffers_alloc()
+static size_t lcd_buffer_size = 0;
 static uint8_t* lcd_buffer1 = nullptr;
 static uint8_t* lcd_buffer2 = nullptr;
-static bool lcd_sleeping = false;
+#else
+// the rows bands are composed in off screen
+static uint8_t* lcd_scratch = nullptr;
+#endif
+// the ST7789 sleep/wake state machine. Transitions
+// are timed instead of delayed so nothing blocks
+enum struct lcd_power_state {
+    awake,
+    sleeping,  // sent sleep in
+    asleep,
+    waking     // sent sleep out
+};
+static lcd_power_state lcd_power = lcd_power_state::awake;
+static bool lcd_power_wanted = true;
+static uint32_t lcd_power_ts = 0;
+static uint32_t lcd_sleep_in_ts = 0;
+static uint32_t lcd_wake_request_ts = 0;
+// panel power counters, reported by FRAME_STATS builds
+static uint32_t lcd_wakes = 0;
+static uint32_t lcd_wake_latency_ms = 0;
+static uint32_t lcd_wake_latency_max_ms = 0;
+static uint32_t lcd_blocked_us = 0;
 static dimmer_t lcd_dimmer;
+#ifdef FRAME_STATS
+// how often the frame stats are reported, in ms
+#ifndef FRAME_STATS_INTERVAL
+#define FRAME_STATS_INTERVAL 5000
+#endif
+// per drawn frame, in microseconds: the time in
+// main_screen.update(), the time in uix_on_flush(), the
+// time the panel spent transferring, and the time every
+// strip was in flight so uix had to wait in flush_complete.
+// Plus the bytes sent
+static rolling_stat frame_render_stat;
+static rolling_stat frame_flush_stat;
+static rolling_stat frame_bus_stat;
+static rolling_stat frame_wait_stat;
+static rolling_stat frame_bytes_stat;
+// from the scanner seeing an i2c change to
+// the render thread taking it, in milliseconds
+static rolling_stat frame_i2c_stat;
+// the current frame's totals. The bus and wait
+// times are added to from the flush ready callback
+static uint32_t frame_flush_us = 0;
+static uint32_t frame_bytes = 0;
+static std::atomic<uint32_t> frame_bus_us(0);
+static std::atomic<uint32_t> frame_wait_us(0);
+// a drawn frame's transfers end after update() returns
+// so its bus time is sampled on a later frame
+static bool frame_bus_pending = false;
+// the transfers in flight, when each was queued, when
+// the last one finished, and when all the strips were
+// last in flight
+static std::atomic<int> frame_in_flight(0);
+static uint32_t frame_queue_ts[2];
+static std::atomic<unsigned> frame_queue_head(0);
+static std::atomic<unsigned> frame_queue_tail(0);
+static uint32_t frame_ready_ts = 0;
+static uint32_t frame_full_ts = 0;
+// frames run and drawn since the last report
+static uint32_t frame_count = 0;
+static uint32_t frame_drawn = 0;
+static uint32_t frame_report_ts = 0;
+#ifdef FRAME_STATS_OVERLAY
+static char frame_overlay_text[32];
+#endif
+// time each task has spent working, and the
+// totals at the last report, in microseconds
+static std::atomic<uint32_t> probe_busy_us(0);
+static std::atomic<uint32_t> i2c_busy_us(0);
+static std::atomic<uint32_t> render_busy_us(0);
+static uint32_t frame_busy_last[4];
+#endif
 
 // button data
 static button_a_raw_t button_a_raw;      // right
@@ -118,40 +291,80 @@ void setup() {
     SPIFFS.begin(true, "/spiffs", 1);
     if (SPIFFS.exists("/settings")) {
         File file = SPIFFS.open("/settings");
-        file.read((uint8_t*)&serial_baud_index, sizeof(serial_baud_index));
-        file.read((uint8_t*)&serial_bin, sizeof(serial_bin));
+        size_t baud_index = 0;
+        bool bin = false;
+        file.read((uint8_t*)&baud_index, sizeof(baud_index));
+        file.read((uint8_t*)&bin, sizeof(bin));
         file.close();
+        serial_baud_index = baud_index;
+        serial_bin = bin;
         puts("Loaded settings");
     }
     // begin serial probe
-    SER.begin(serial_bauds[serial_baud_index], SERIAL_8N1, SER_RX, -1);
-
-    // allocate the primary display buffer
-    lcd_buffer1 = (uint8_t*)malloc(lcd_buffer_size);
-    if (lcd_buffer1 == nullptr) {
-        puts("Error: Out of memory allocating lcd_buffer1");
+    if (serial_baud_index >= serial_bauds_size) {
+        serial_baud_index = 0;
+    }
+    if (!serial_capture_begin(serial_bauds[serial_baud_index], SERIAL_CAPTURE_SIZE)) {
+        puts("Could not start serial capture");
+        while (1)
+            ;
+    }
+    // initialize the UI components and allocate the display
+    // text and serial buffers now that we know the probe
+    // dimensions. This is done before the strips so they
+    // only have to leave room for what comes after
+    main_screen.dimensions({LCD_WIDTH,LCD_HEIGHT});
+    ui_init();
+    if (!probe_init()) {
+        while (1)
+            ;
+    }
+    // the views handed between the probe and render threads
+    for (size_t i = 0; i < 3; ++i) {
+        probe_view& view = probe_views.slot(i);
+        view.serial = false;
+        view.text = (char*)malloc(display_text_capacity);
+        if (view.text == nullptr) {
+            puts("Could not allocate the probe views");
+            while (1)
+                ;
+        }
+    }
+#ifdef LCD_DIRECT_RENDER
+    // the screen draws into the panel's frame buffer so
+    // there are no strips, just the rows it composes in
+    lcd_scratch = (uint8_t*)heap_caps_malloc(
+        gfx::bitmap<rgb_pixel<LCD_BIT_DEPTH>>::sizeof_buffer(LCD_WIDTH, LCD_DIRECT_SCRATCH_HEIGHT),
+        MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (lcd_scratch == nullptr) {
+        puts("Error: Out of memory allocating the display buffers");
+        while (1)
+            ;
+    }
+    lcd_panel_init();
+#else
+    // allocate the display buffers. The panel's
+    // largest transfer is a strip
+    if (!lcd_buffers_alloc()) {
+        puts("Error: Out of memory allocating the display buffers");
         while (1)
             ;
     }
     lcd_panel_init(lcd_buffer_size,lcd_flush_ready);
+#endif
     lcd_dimmer.initialize();
-    // clear the i2c data
-    memset(&i2c_addresses_old, 0, sizeof(i2c_addresses_old));
-    memset(&i2c_addresses, 0, sizeof(i2c_addresses));
     // start up the i2c updater
-    i2c_updater_ran = false;
-    i2c_update_sync = xSemaphoreCreateMutex();
-    if (i2c_update_sync == nullptr) {
-        puts("Could not allocate I2C updater semaphore");
+    i2c_events = xQueueCreate(I2C_EVENT_QUEUE_SIZE, sizeof(i2c_queued_event));
+    if (i2c_events == nullptr) {
+        puts("Could not allocate I2C event queue");
         while (1)
             ;
     }
-    // 1-affinity = use the core that isn't this one:
-    i2c_updater = thread::create_affinity(1 - thread::current().affinity(),
+    i2c_updater = thread::create_affinity(I2C_CORE,
                                           i2c_update_task,
                                           nullptr,
                                           10,
-                                          2000);
+                                          I2C_STACK_SIZE);
     if (i2c_updater.handle() == nullptr) {
         puts("Could not allocate I2C updater thread");
         while (1)
@@ -170,47 +383,90 @@ void setup() {
         while (1)
             ;
     }
-    // allocate the second display buffer (optional)
-    lcd_buffer2 = (uint8_t*)malloc(lcd_buffer_size);
-    if (lcd_buffer2 == nullptr) {
-        puts("Warning: Out of memory allocating lcd_buffer2.");
-        puts("Performance may be degraded. Try a smaller lcd_buffer_size");
+#ifdef LCD_DIRECT_RENDER
+    if (lcd_panel_frame_buffer() == nullptr) {
+        puts("Could not get the panel frame buffer");
+        while (1)
+            ;
     }
-    main_screen.dimensions({LCD_WIDTH,LCD_HEIGHT});
+    main_screen.frame_buffer(lcd_panel_frame_buffer());
+    main_screen.buffer(lcd_scratch,
+                       gfx::bitmap<rgb_pixel<LCD_BIT_DEPTH>>::sizeof_buffer(LCD_WIDTH, LCD_DIRECT_SCRATCH_HEIGHT));
+#else
     main_screen.buffer_size(lcd_buffer_size);
     main_screen.buffer1(lcd_buffer1);
     main_screen.buffer2(lcd_buffer2);
+#endif
     main_screen.on_flush_callback(uix_on_flush);
-    // initialize the UI components
-    ui_init();
-    // compute the amount of string we need to fill the display
-    display_text_capacity = probe_cols * (probe_rows + 1) + 1;
-    // and allocate it (shouldn't be much)
-    display_text = (char*)malloc(display_text_capacity);
-    if (display_text == nullptr) {
-        puts("Could not allocate display text");
+    // start formatting on the probe core
+    prober = thread::create_affinity(PROBE_CORE,
+                                     probe_task,
+                                     nullptr,
+                                     5,
+                                     PROBE_STACK_SIZE);
+    if (prober.handle() == nullptr) {
+        puts("Could not allocate probe thread");
         while (1)
             ;
     }
-    *display_text = '\0';
-    // compute and allocate our serial buffer
-    // similar to above
-    serial_data_capacity = probe_cols * probe_rows;
-    serial_data = (uint8_t*)malloc(serial_data_capacity);
-    if (serial_data == nullptr) {
-        puts("Could not allocate serial data");
+    prober.start();
+    // and the main logic on the render core
+    renderer = thread::create_affinity(RENDER_CORE,
+                                       render_task,
+                                       nullptr,
+                                       5,
+                                       RENDER_STACK_SIZE);
+    if (renderer.handle() == nullptr) {
+        puts("Could not allocate render thread");
         while (1)
             ;
     }
+    renderer.start();
     // report the memory vitals
     printf("SRAM free: %0.1fKB\n",
                    (float)ESP.getFreeHeap() / 1024.0);
     printf("SRAM largest free block: %0.1fKB\n",
                    (float)ESP.getMaxAllocHeap() / 1024.0);
+    printf("Frame rate cap: %d FPS\n", (int)RENDER_FPS);
+    printf("Cores: capture %d, probe %d, i2c %d, render %d\n",
+           (int)CAPTURE_CORE,
+           (int)PROBE_CORE,
+           (int)I2C_CORE,
+           (int)RENDER_CORE);
     puts("");
 }
 
 void loop() {
+    // everything happens on the render thread
+    vTaskDelete(NULL);
+}
+// runs the main logic at the target frame rate
+static void render_task(void* state) {
+    TickType_t frame_ticks = pdMS_TO_TICKS(1000 / RENDER_FPS);
+    if (frame_ticks == 0) {
+        frame_ticks = 1;
+    }
+    TickType_t wake_ts = xTaskGetTickCount();
+    while (true) {
+#ifdef FRAME_STATS
+        const uint32_t ts = micros();
+        render_frame();
+        render_busy_us += micros() - ts;
+#else
+        render_frame();
+#endif
+        if (xTaskGetTickCount() - wake_ts >= frame_ticks) {
+            // the frame ran long. Start the next one
+            // now rather than trying to catch up
+            wake_ts = xTaskGetTickCount();
+            taskYIELD();
+        } else {
+            // sleep off the rest of the frame
+            vTaskDelayUntil(&wake_ts, frame_ticks);
+        }
+    }
+}
+static void render_frame() {
     // timeout the serial settings display
     // if it's showing
     if (serial_msg_ts && millis() > serial_msg_ts + 1000) {
@@ -219,34 +475,56 @@ void loop() {
         probe_msg_label2.visible(false);
         serial_msg_ts = 0;
     }
-    // pause the app while the buttons are pressed
-    while (button_a.pressed() || button_b.pressed()) {
-        button_a.update();
-        button_b.update();
-    }
     // give everything a chance to update
     lcd_dimmer.update();
     button_a.update();
     button_b.update();
-    // if the i2c has changed, update the display
-    if (refresh_i2c()) {
-        is_serial = false;
-        probe_painter.visible(true);
-        probe_label.color(color32_t::green);
-        probe_label.text(display_text);
-        probe_label.visible(true);
-        lcd_wake();
-        lcd_dimmer.wake();
-        // otherwise if the serial has changed,
-        // update the display
-    } else if (refresh_serial()) {
-        is_serial = true;
-        probe_painter.visible(true);
-        probe_label.color(color32_t::yellow);
-        probe_label.text(display_text);
-        probe_label.visible(true);
-        lcd_wake();
-        lcd_dimmer.wake();
+    // holding a button freezes the view. Capture,
+    // counting and the monitor echo carry on in
+    // the probe thread, and its latest view waits
+    bool paused = button_a.pressed() || button_b.pressed();
+    if (paused && !view_paused) {
+        view_paused = true;
+        view_paused_received = probe_received;
+    }
+    if (!paused) {
+        if (view_paused) {
+            view_paused = false;
+            // say how much arrived while we were held,
+            // unless a button is already showing something
+            size_t received = probe_received - view_paused_received;
+            if (received && !serial_msg_ts) {
+                snprintf(view_paused_msg, sizeof(view_paused_msg), "%u B", (unsigned)received);
+                msg_painter.visible(true);
+                probe_msg_label1.text("[ paused ]");
+                probe_msg_label2.text(view_paused_msg);
+                probe_msg_label1.visible(true);
+                probe_msg_label2.visible(true);
+                serial_msg_ts = millis();
+            }
+        }
+        // if the probe thread has a new view, show it
+        if (probe_views.take()) {
+            const probe_view& view = probe_views.front();
+#ifdef FRAME_STATS
+            if (view.i2c_ms) {
+                frame_i2c_stat.add(millis() - view.i2c_ms);
+            }
+#endif
+            if (!view.serial) {
+                probe_painter.visible(true);
+                probe_label.color(color32_t::green);
+                probe_label.text(view.text);
+                probe_label.visible(true);
+            } else {
+                probe_painter.visible(true);
+                probe_label.color(color32_t::yellow);
+                probe_label.text(view.text);
+                probe_label.visible(true);
+            }
+            lcd_wake();
+            lcd_dimmer.wake();
+        }
     }
     // if we're dimmed all the way, just
     // sleep, and stop updating the
@@ -257,49 +535,341 @@ void loop() {
         lcd_sleep();
     } else {
         lcd_wake();
-        main_screen.update();
+        // if the panel is still waking, the dirty
+        // regions accumulate until it's ready
+        if (lcd_ready()) {
+#ifdef FRAME_STATS
+            frame_stats_begin();
+            const uint32_t update_ts = micros();
+            main_screen.update();
+            frame_stats_end(micros() - update_ts);
+#else
+            main_screen.update();
+#endif
+        }
+    }
+#ifdef FRAME_STATS
+    if (millis() - frame_report_ts >= FRAME_STATS_INTERVAL) {
+        frame_stats_report();
     }
+#endif
 }
+#ifdef FRAME_STATS
+static void frame_stats_begin() {
+    ++frame_count;
+    if (frame_bus_pending && frame_in_flight == 0) {
+        frame_bus_stat.add(frame_bus_us.exchange(0));
+        frame_wait_stat.add(frame_wait_us.exchange(0));
+        frame_bus_pending = false;
+    }
+    frame_flush_us = 0;
+    frame_bytes = 0;
+}
+static void frame_stats_end(uint32_t update_us) {
+    if (frame_bytes == 0) {
+        // nothing was drawn
+        return;
+    }
+    ++frame_drawn;
+    frame_render_stat.add(update_us);
+    frame_flush_stat.add(frame_flush_us);
+    frame_bytes_stat.add(frame_bytes);
+    frame_bus_pending = true;
+}
+// notes a transfer being queued
+static void frame_stats_queued(uint32_t ts) {
+#ifndef LCD_DIRECT_RENDER
+    const unsigned tail = frame_queue_tail;
+    frame_queue_ts[tail & 1] = ts;
+    frame_queue_tail = tail + 1;
+    // with every strip in flight uix can't
+    // render until the panel frees one
+    if (++frame_in_flight == (lcd_buffer2 != nullptr ? 2 : 1)) {
+        frame_full_ts = ts;
+    }
+#endif
+}
+#ifndef LCD_DIRECT_RENDER
+// notes a transfer finishing. Called from the
+// flush ready callback
+static void frame_stats_ready() {
+    const uint32_t ts = micros();
+    const unsigned head = frame_queue_head;
+    // a transfer queued behind another
+    // starts when that one finishes
+    uint32_t start = frame_queue_ts[head & 1];
+    if ((int32_t)(frame_ready_ts - start) > 0) {
+        start = frame_ready_ts;
+    }
+    frame_queue_head = head + 1;
+    frame_bus_us += ts - start;
+    frame_ready_ts = ts;
+    if (frame_in_flight-- == (lcd_buffer2 != nullptr ? 2 : 1)) {
+        frame_wait_us += ts - frame_full_ts;
+    }
+}
+#endif
+static void frame_stats_report() {
+    const uint32_t ms = millis();
+    const uint32_t elapsed = ms - frame_report_ts;
+    frame_report_ts = ms;
+    const float fps = elapsed ? frame_drawn * 1000.0f / elapsed : 0.0f;
+    // the probe thread owns the staged monitor
+    // output so this goes straight out
+    printf("[frames: %u run, %u drawn, %0.1f/s]\n",
+           (unsigned)frame_count,
+           (unsigned)frame_drawn,
+           fps);
+    if (frame_render_stat.count()) {
+        const rolling_stat* stats[] = {&frame_render_stat, &frame_flush_stat, &frame_bus_stat, &frame_wait_stat, &frame_bytes_stat};
+        const char* names[] = {"render us", "flush us", "bus us", "wait us", "bytes"};
+        for (size_t i = 0; i < sizeof(stats) / sizeof(stats[0]); ++i) {
+            printf("[%-9s p50 %7u p95 %7u max %7u]\n",
+                   names[i],
+                   (unsigned)stats[i]->percentile(50),
+                   (unsigned)stats[i]->percentile(95),
+                   (unsigned)stats[i]->max());
+        }
+        // if update() spends most of its time waiting on
+        // the panel, the bus is the bottleneck
+        const uint32_t render_us = frame_render_stat.percentile(50);
+        const uint32_t wait_us = frame_wait_stat.percentile(50);
+        puts(wait_us * 2 > render_us ? "[bus bound]" : "[cpu bound]");
+    }
+    if (frame_i2c_stat.count()) {
+        printf("[%-9s p50 %7u p95 %7u max %7u]\n",
+               "i2c ms",
+               (unsigned)frame_i2c_stat.percentile(50),
+               (unsigned)frame_i2c_stat.percentile(95),
+               (unsigned)frame_i2c_stat.max());
+    }
+    // how busy the app's tasks kept each core
+    serial_capture_stats_t capture_stats;
+    serial_capture_statistics(&capture_stats);
+    const uint32_t busy[] = {capture_stats.busy_us, probe_busy_us, i2c_busy_us, render_busy_us};
+    const int busy_cores[] = {CAPTURE_CORE, PROBE_CORE, I2C_CORE, RENDER_CORE};
+    const char* busy_names[] = {"capture", "probe", "i2c", "render"};
+    uint32_t core_us[2] = {0, 0};
+    for (size_t i = 0; i < sizeof(busy) / sizeof(busy[0]); ++i) {
+        const uint32_t us = busy[i] - frame_busy_last[i];
+        frame_busy_last[i] = busy[i];
+        core_us[busy_cores[i]] += us;
+        printf("[%-7s core %d %5.1f%%]\n",
+               busy_names[i],
+               busy_cores[i],
+               elapsed ? us / (elapsed * 10.0f) : 0.0f);
+    }
+    for (int i = 0; i < portNUM_PROCESSORS && i < 2; ++i) {
+        printf("[core %d %5.1f%% busy]\n",
+               i,
+               elapsed ? core_us[i] / (elapsed * 10.0f) : 0.0f);
+    }
+    if (lcd_wakes) {
+        printf("[panel %u wakes, last %ums, max %ums, %uus blocked]\n",
+               (unsigned)lcd_wakes,
+               (unsigned)lcd_wake_latency_ms,
+               (unsigned)lcd_wake_latency_max_ms,
+               (unsigned)lcd_blocked_us);
+    }
+#ifdef FRAME_STATS_OVERLAY
+    snprintf(frame_overlay_text,
+             sizeof(frame_overlay_text),
+             "%0.1ffps %ums %ums",
+             fps,
+             (unsigned)(frame_render_stat.percentile(50) / 1000),
+             (unsigned)(frame_bus_stat.percentile(50) / 1000));
+    stats_label.text(frame_overlay_text);
+#endif
+    frame_count = 0;
+    frame_drawn = 0;
+}
+#endif
 // writes bitmap data to the lcd panel api
 static void uix_on_flush(const rect16& bounds,
                          const void* bmp,
                          void* state) {
+#ifdef FRAME_STATS
+    const uint32_t flush_ts = micros();
+    frame_stats_queued(flush_ts);
+    frame_bytes += (bounds.x2 - bounds.x1 + 1) * (bounds.y2 - bounds.y1 + 1) * ((LCD_BIT_DEPTH + 7) / 8);
+#endif
+#ifdef LCD_DIRECT_RENDER
+    // the rows are already in the frame buffer. They
+    // just need to get out of the cache
+    lcd_panel_frame_buffer_flush(bounds.y1, bounds.y2);
+#else
     lcd_panel_draw_bitmap(  bounds.x1,
                               bounds.y1,
                               bounds.x2,
                               bounds.y2,
                               (void*)bmp);
+#endif
+#ifdef FRAME_STATS
+    frame_flush_us += micros() - flush_ts;
+#endif
+}
+#ifndef LCD_DIRECT_RENDER
+// allocates the strip buffers, preferring DMA capable internal
+// RAM so the SPI driver doesn't have to bounce them, then two
+// strips so rendering can overlap the transfer, then taller
+// strips. PSRAM is the last resort
+static bool lcd_buffers_alloc() {
+    const size_t row_size = gfx::bitmap<rgb_pixel<LCD_BIT_DEPTH>>::sizeof_buffer(LCD_WIDTH, 1);
+    const uint32_t dma_caps = MALLOC_CAP_DMA | MALLOC_CAP_8BIT;
+    const uint32_t psram_caps = MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT;
+    const uint32_t ts = micros();
+    // the ui and probe buffers are already allocated
+    const size_t reserve = I2C_STACK_SIZE +
+                           PROBE_STACK_SIZE +
+                           RENDER_STACK_SIZE +
+                           title_svg.cache_bytes() +
+                           LCD_STRIP_HEAP_RESERVE;
+    uint32_t caps = dma_caps;
+    size_t height = 0;
+    for (int pass = 0; pass < 2 && lcd_buffer1 == nullptr; ++pass) {
+        if (pass == 1) {
+            if (heap_caps_get_free_size(psram_caps) == 0) {
+                break;
+            }
+            caps = psram_caps;
+        }
+        size_t free = heap_caps_get_free_size(caps);
+        // internal RAM has to leave room for the rest
+        // of the app. PSRAM has nothing else to do
+        if (caps == dma_caps) {
+            free = free > reserve ? free - reserve : 0;
+        }
+        for (int count = 2; count > 0 && lcd_buffer1 == nullptr; --count) {
+            height = free / count / row_size;
+            if (height > LCD_STRIP_MAX_HEIGHT) {
+                height = LCD_STRIP_MAX_HEIGHT;
+            }
+            // the heap may be fragmented so shrink
+            // until each strip finds a block
+            while (height >= LCD_STRIP_MIN_HEIGHT) {
+                lcd_buffer1 = (uint8_t*)heap_caps_malloc(height * row_size, caps);
+                if (lcd_buffer1 != nullptr) {
+                    if (count == 1) {
+                        break;
+                    }
+                    lcd_buffer2 = (uint8_t*)heap_caps_malloc(height * row_size, caps);
+                    if (lcd_buffer2 != nullptr) {
+                        break;
+                    }
+                    heap_caps_free(lcd_buffer1);
+                    lcd_buffer1 = nullptr;
+                }
+                height = height * 3 / 4;
+            }
+        }
+    }
+    if (lcd_buffer1 == nullptr) {
+        return false;
+    }
+    lcd_buffer_size = height * row_size;
+    printf("Display strips: %d x %d rows (%0.1fKB each, %s) in %uus\n",
+           lcd_buffer2 != nullptr ? 2 : 1,
+           (int)height,
+           (float)lcd_buffer_size / 1024.0,
+           caps == dma_caps ? "DMA capable internal" : "PSRAM",
+           (unsigned)(micros() - ts));
+    if (caps != dma_caps) {
+        // the SPI driver copies buffers it can't DMA from
+        // into internal RAM before each transfer. Time a
+        // strip's worth of that to show what it costs
+        uint8_t bounce[1024];
+        uint32_t bounce_ts = micros();
+        for (size_t offs = 0; offs < lcd_buffer_size; offs += sizeof(bounce)) {
+            const size_t size = lcd_buffer_size - offs < sizeof(bounce) ? lcd_buffer_size - offs : sizeof(bounce);
+            memcpy(bounce, lcd_buffer1 + offs, size);
+            // keep the copy from being optimized out
+            asm volatile("" ::: "memory");
+        }
+        const uint32_t bounce_us = micros() - bounce_ts;
+        printf("Warning: PSRAM strips cost %uus to bounce each, ~%uus a frame\n",
+               (unsigned)bounce_us,
+               (unsigned)(bounce_us * ((LCD_HEIGHT + height - 1) / height)));
+    }
+    return true;
 }
 // informs UIX that a previous flush was complete
 static bool lcd_flush_ready(esp_lcd_panel_io_handle_t panel_io,
                             esp_lcd_panel_io_event_data_t* edata,
                             void* user_ctx) {
+#ifdef FRAME_STATS
+    frame_stats_ready();
+#endif
     main_screen.flush_complete();
     return true;
 }
+#endif
+// sends a parameterless command to the ST7789
+static void lcd_command(uint8_t cmd) {
+    uint32_t ts = micros();
+    uint8_t params[] = {};
+    esp_lcd_panel_io_tx_param(lcd_io_handle,
+                              cmd,
+                              params,
+                              sizeof(params));
+    lcd_blocked_us += micros() - ts;
+}
 // puts the ST7789 to sleep
 static void lcd_sleep() {
-    if (!lcd_sleeping) {
-        uint8_t params[] = {};
-        esp_lcd_panel_io_tx_param(lcd_io_handle,
-                                  0x10,
-                                  params,
-                                  sizeof(params));
-        delay(5);
-        lcd_sleeping = true;
-    }
+    lcd_power_wanted = false;
+    lcd_ready();
 }
 // wakes the ST7789
 static void lcd_wake() {
-    if (lcd_sleeping) {
-        uint8_t params[] = {};
-        esp_lcd_panel_io_tx_param(lcd_io_handle,
-                                  0x11,
-                                  params,
-                                  sizeof(params));
-        delay(120);
-        lcd_sleeping = false;
+    if (!lcd_power_wanted) {
+        lcd_power_wanted = true;
+        lcd_wake_request_ts = millis();
+    }
+    lcd_ready();
+}
+// moves the ST7789 through sleep in/sleep out
+// once each command's settle time has passed
+static bool lcd_ready() {
+    uint32_t ms = millis();
+    switch (lcd_power) {
+        case lcd_power_state::awake:
+            if (!lcd_power_wanted) {
+                lcd_command(0x10);
+                lcd_power = lcd_power_state::sleeping;
+                lcd_power_ts = lcd_sleep_in_ts = ms;
+            }
+            break;
+        case lcd_power_state::sleeping:
+            // 5ms before the next command
+            if (ms - lcd_power_ts >= 5) {
+                lcd_power = lcd_power_state::asleep;
+                return lcd_ready();
+            }
+            break;
+        case lcd_power_state::asleep:
+            // 120ms after sleep in before sleep out
+            if (lcd_power_wanted && ms - lcd_sleep_in_ts >= 120) {
+                lcd_command(0x11);
+                lcd_power = lcd_power_state::waking;
+                lcd_power_ts = ms;
+            }
+            break;
+        case lcd_power_state::waking:
+            // 120ms after sleep out before it's usable
+            // (and before sleep in is allowed)
+            if (ms - lcd_power_ts >= 120) {
+                lcd_power = lcd_power_state::awake;
+                if (lcd_power_wanted) {
+                    ++lcd_wakes;
+                    lcd_wake_latency_ms = ms - lcd_wake_request_ts;
+                    if (lcd_wake_latency_ms > lcd_wake_latency_max_ms) {
+                        lcd_wake_latency_max_ms = lcd_wake_latency_ms;
+                    }
+                }
+                return lcd_ready();
+            }
+            break;
     }
+    return lcd_power == lcd_power_state::awake;
 }
 // saves the current configuration to flash
 static void save_settings() {
@@ -310,8 +880,10 @@ static void save_settings() {
         file = SPIFFS.open("/settings", "wb");
         file.seek(0);
     }
-    file.write((uint8_t*)&serial_baud_index, sizeof(serial_baud_index));
-    file.write((uint8_t*)&serial_bin, sizeof(serial_bin));
+    const size_t baud_index = serial_baud_index;
+    const bool bin = serial_bin;
+    file.write((uint8_t*)&baud_index, sizeof(baud_index));
+    file.write((uint8_t*)&bin, sizeof(bin));
     file.close();
 }
 // right button on click
@@ -325,17 +897,16 @@ static void button_a_on_click(int clicks, void* state) {
     }
     // eat all the clicks, setting serial_bin
     // accordingly
-    serial_bin = (serial_bin + (clicks & 1)) & 1;
+    const bool bin = (serial_bin + (clicks & 1)) & 1;
+    serial_bin = bin;
     // update the message controls
     msg_painter.visible(true);
     probe_msg_label1.text("[ mode ]");
-    probe_msg_label2.text(serial_bin ? "bin" : "txt");
+    probe_msg_label2.text(bin ? "bin" : "txt");
     probe_msg_label1.visible(true);
     probe_msg_label2.visible(true);
     // start the message timeout
     serial_msg_ts = millis();
-    // ensure the screen is up to date
-    main_screen.update();
     // save the config
     save_settings();
 }
@@ -349,13 +920,15 @@ static void button_a_on_long_click(void* state) {
         return;
     }
     // otherwise, change baud rate
-    if (++serial_baud_index == serial_bauds_size) {
-        serial_baud_index = 0;
+    size_t baud_index = serial_baud_index + 1;
+    if (baud_index == serial_bauds_size) {
+        baud_index = 0;
     }
+    serial_baud_index = baud_index;
     // update the message controls
     probe_msg_label1.text("[ baud ]");
     char buf[16];
-    int baud = (int)serial_bauds[serial_baud_index];
+    int baud = (int)serial_bauds[baud_index];
     itoa((int)baud, buf, 10);
     msg_painter.visible(true);
     probe_msg_label2.text(buf);
@@ -364,9 +937,7 @@ static void button_a_on_long_click(void* state) {
     // start the message timeout
     serial_msg_ts = millis();
     // update the baud rate
-    SER.updateBaudRate(baud);
-    // update the main screen
-    main_screen.update();
+    serial_capture_baud(baud);
     // save the config
     save_settings();
 }
@@ -376,204 +947,179 @@ static void button_b_on_click(int clicks, void* state) {
     lcd_wake();
     lcd_dimmer.wake();
 }
-// scan the i2c bus periodically
-// (runs on alternative core)
-void i2c_update_task(void* state) {
+// format the probe output as it arrives, building
+// the next view whenever the render thread has
+// taken the last one (runs on the probe core)
+static void probe_task(void* state) {
+    // what the next view will show. The latest wins
+    view_change next = view_change::none;
     while (true) {
-        vTaskDelay(1);
-        I2C.begin(I2C_SDA, I2C_SCL);
-        // ensure pullups
-        i2c_set_pin(0, I2C_SDA, I2C_SCL, true, true, I2C_MODE_MASTER);
-        // catch slow devices
-        I2C.setTimeOut(uint16_t(-1));
-        // clear the banks
-        uint32_t banks[4];
-        memset(banks, 0, sizeof(banks));
-        // for every address
-        for (byte i = 0; i < 127; i++) {
-            // start a transmission, and see
-            // if it's successful
-            I2C.beginTransmission(i);
-            if (I2C.endTransmission() == 0) {
-                // if so, set the corresponding bit
-                banks[i / 32] |= (1 << (i % 32));
+#ifdef FRAME_STATS
+        const uint32_t ts = micros();
+#endif
+        if (refresh_i2c()) {
+            next = view_change::i2c;
+        } else if (probe_refresh_serial()) {
+            next = view_change::serial;
+        }
+        probe_received = serial_received;
+        // the monitor only takes what fits in its FIFO, so
+        // keep sending the rest of a burst once it goes quiet
+        if (probe_monitor.size()) {
+            probe_monitor.flush();
+        }
+        if (next != view_change::none && !probe_views.pending()) {
+            probe_view& view = probe_views.back();
+            if (next == view_change::i2c) {
+                probe_show_i2c();
+            } else {
+                probe_show_serial();
             }
+            view.serial = next == view_change::serial;
+            view.i2c_ms = view.serial ? 0 : probe_i2c_ms;
+            probe_i2c_ms = 0;
+            memcpy(view.text, display_text, display_text_capacity);
+            probe_views.publish();
+            next = view_change::none;
         }
-        I2C.end();
-        // safely update the main address list
-        xSemaphoreTake(i2c_update_sync, portMAX_DELAY);
-        memcpy(i2c_addresses, banks, sizeof(banks));
-        xSemaphoreGive(i2c_update_sync);
-        // say we ran
-        i2c_updater_ran = true;
-        delay(1000);
+#ifdef FRAME_STATS
+        probe_busy_us += micros() - ts;
+#endif
+        vTaskDelay(pdMS_TO_TICKS(PROBE_INTERVAL_MS));
     }
 }
-// refresh the i2c display if it has changed,
-// reporting true if so
-static bool refresh_i2c() {
-    uint32_t banks[4];
-    // don't try anything until we've run once
-    if (i2c_updater_ran) {
-        // safely copy out the share address list
-        xSemaphoreTake(i2c_update_sync, portMAX_DELAY);
-        memcpy(banks, i2c_addresses, sizeof(banks));
-        xSemaphoreGive(i2c_update_sync);
-        // if our addresses have changed
-        if (memcmp(banks, i2c_addresses_old, sizeof(banks))) {
-            char buf[32];
-            *display_text = '\0';
-            int count = 0;
-            // for each address
-            for (int i = 0; i < 128; ++i) {
-                int mask = 1 << (i % 32);
-                int bank = i / 32;
-                // if its bit is set
-                if (banks[bank] & mask) {
-                    // if we still have room
-                    if (count < probe_rows - 1) {
-                        // insert newlines at the end of the
-                        // previous row, if there was one
-                        if (count) {
-                            strcat(display_text, "\n");
-                        }
-                        ++count;
-                        // display an address
-                        snprintf(buf, sizeof(buf), "0x%02X:%d", i, i);
-                        strncat(display_text, buf, sizeof(buf));
-                    }
-                    printf("0x%02X:%d\n", i, i);
-                }
+// poll and sweep the i2c bus as the scanner schedules
+// (runs on the i2c core)
+void i2c_update_task(void* state) {
+#ifdef I2C_SCAN_BENCH
+    // time a sweep each way once
+    uint32_t wire_banks[4];
+    uint32_t link_banks[4];
+    uint32_t wire_ts = micros();
+    const bool wire_swept = probe_scan_i2c_wire(wire_banks);
+    const uint32_t wire_us = micros() - wire_ts;
+    uint32_t link_ts = micros();
+    const bool link_swept = probe_scan_i2c(link_banks);
+    const uint32_t link_us = micros() - link_ts;
+    const char* outcome = "same results";
+    if (!wire_swept || !link_swept) {
+        outcome = "a sweep failed";
+    } else if (memcmp(wire_banks, link_banks, sizeof(wire_banks))) {
+        outcome = "results differ";
+    }
+    printf("I2C sweep: %uus with Wire, %uus with command links, %s\n",
+           (unsigned)wire_us,
+           (unsigned)link_us,
+           outcome);
+#endif
+    i2c_scan.on_event_callback(i2c_on_event);
+#ifdef I2C_WATCH
+    for (size_t i = 0; i < sizeof(i2c_watch); ++i) {
+        i2c_scan.watch(i2c_watch[i]);
+    }
+#endif
+#ifdef FRAME_STATS
+    uint32_t report_ts = millis();
+    uint32_t report_busy_us = 0;
+#endif
+    while (true) {
+#ifdef FRAME_STATS
+        const uint32_t ts = micros();
+        const bool changed = i2c_scan.update(millis());
+        i2c_busy_us += micros() - ts;
+#else
+        const bool changed = i2c_scan.update(millis());
+#endif
+        if (changed || i2c_events_lost) {
+            // keep the whole list too, for when
+            // the event queue overflows
+            i2c_snapshot snapshot;
+            memcpy(snapshot.banks, i2c_scan.banks(), sizeof(snapshot.banks));
+            i2c_addresses.write(snapshot);
+            if (i2c_events_lost.exchange(false)) {
+                i2c_resync = true;
             }
-            if (!count) {
-                // display none if there weren't any
-                memcpy(display_text, "<none>\0", 7);
-                puts("<none>");
+        }
+#ifdef FRAME_STATS
+        const uint32_t elapsed = millis() - report_ts;
+        if (elapsed >= FRAME_STATS_INTERVAL) {
+            // bus occupancy is the time spent probing
+            const uint32_t busy_us = i2c_scan.busy_us() - report_busy_us;
+            report_busy_us = i2c_scan.busy_us();
+            report_ts = millis();
+            const rolling_stat& latency = i2c_scan.latency();
+            printf("[i2c bus %5.1f%% busy, sweep every %ums, %u sweeps, %u polls, %u failed]\n",
+                   busy_us / (elapsed * 10.0f),
+                   (unsigned)i2c_scan.sweep_ms(),
+                   (unsigned)i2c_scan.sweeps(),
+                   (unsigned)i2c_scan.polls(),
+                   (unsigned)i2c_scan.failures());
+            if (latency.count()) {
+                printf("[i2c hot-plug ms p50 %5u p95 %5u max %5u, %u changes]\n",
+                       (unsigned)latency.percentile(50),
+                       (unsigned)latency.percentile(95),
+                       (unsigned)latency.max(),
+                       (unsigned)i2c_scan.changes());
+            }
+            // the driver stays installed, so say
+            // when bus errors made it start over
+            if (probe_i2c_session.inits() > 1) {
+                printf("[i2c %u bus errors, %u installs, last %uus, max %uus]\n",
+                       (unsigned)probe_i2c_session.errors(),
+                       (unsigned)probe_i2c_session.inits(),
+                       (unsigned)probe_i2c_session.last_init_us(),
+                       (unsigned)probe_i2c_session.max_init_us());
             }
-            puts("");
-            // set the old addresses to the latest
-            memcpy(i2c_addresses_old, banks, sizeof(banks));
-            // return true, indicating a change
-            return true;
         }
+#endif
+        // sleep until the next poll or sweep is due
+        uint32_t wait_ms = i2c_scan.next_ms(millis());
+        vTaskDelay(wait_ms ? pdMS_TO_TICKS(wait_ms) : 1);
     }
-    // no change
-    return false;
 }
-// refresh the serial display if it has changed
-// reporting true if so
-static bool refresh_serial() {
-    // get the available data count
-    size_t available = (size_t)SER.available();
-    size_t advanced = 0;
-    // if we have incoming data
-    if (available > 0) {
-        if (available > serial_data_capacity) {
-            available = serial_data_capacity;
+static void i2c_on_event(const i2c_event_t& event, void* state) {
+    // any event means the list changed, so the
+    // next write publishes it
+    const i2c_queued_event queued = {event, i2c_addresses.generation() + 1};
+    // never hold up the scan. The probe thread
+    // catches up from the whole list instead
+    if (xQueueSend(i2c_events, &queued, 0) != pdTRUE) {
+        i2c_events_lost = true;
+    }
+}
+// apply the i2c changes in the order they were seen,
+// reporting true if the list changed
+static bool refresh_i2c() {
+    bool changed = false;
+    bool resync = false;
+    uint32_t resync_generation = 0;
+    if (i2c_resync.exchange(false)) {
+        // events were dropped. Start over from the whole list
+        i2c_snapshot snapshot;
+        resync_generation = i2c_addresses.read(&snapshot);
+        changed = probe_refresh_i2c(snapshot.banks);
+        if (changed && !probe_i2c_ms) {
+            probe_i2c_ms = millis();
         }
-        // start over if we're just switching to serial
-        if (!is_serial) {
-            serial_data_size = 0;
+        resync = true;
+    }
+    bool applied = false;
+    i2c_queued_event queued;
+    while (xQueueReceive(i2c_events, &queued, 0) == pdTRUE) {
+        // the list already has the changes
+        // from its generation and before
+        if (resync && (int32_t)(queued.generation - resync_generation) <= 0) {
+            continue;
         }
-        size_t serial_remaining = serial_data_capacity - serial_data_size;
-        uint8_t* p;
-        if (serial_remaining < available) {
-            size_t to_scroll = available - serial_remaining;
-            // scroll the serial buffer
-            if (to_scroll < serial_data_size) {
-                memmove(serial_data, serial_data + to_scroll, serial_data_size - to_scroll);
+        if (probe_apply_i2c(queued.event.address, queued.event.present)) {
+            if (!probe_i2c_ms) {
+                probe_i2c_ms = queued.event.ms;
             }
-            serial_data_size -= to_scroll;
-        }
-        p = serial_data + serial_data_size;
-        serial_data_size += SER.read(p, available);
-        if (!serial_bin) {  // text
-            // pointer to our display text
-            char* sz = display_text;
-            uint8_t* pb = serial_data;
-            size_t pbc = serial_data_size;
-            // null terminate it
-            *sz = '\0';
-            int cols = 0, rows = 0;
-            do {
-                // get the next serial
-                if (pbc == 0) {
-                    break;
-                }
-                uint8_t b = *pb++;
-                --pbc;
-                // if it's printable, print it
-                // otherwise, print '.'
-                if (b == ' ' || isprint(b)) {
-                    *sz++ = (char)b;
-                    putchar((char)b);
-                } else {
-                    // monitor follows slightly different rules
-                    *sz = '.';
-                    if (b == '\n' || b == '\r' || b == '\t') {
-                        putchar((char)b);
-                    } else {
-                        putchar('.');
-                    }
-                }
-                // insert newlines as necessary
-                if (rows < probe_rows - 1 && ++cols == probe_cols) {
-                    cols = 0;
-                    *sz++ = '\n';
-                    ++rows;
-                }
-                ++advanced;
-            } while (pbc);
-            *sz = '\0';
-        } else {  // binary
-            int bin_cols = probe_cols / 3, rows = 0;
-            int count_bin = (bin_cols)*probe_rows;
-            int mon_cols = 0;
-            uint8_t* pb = serial_data;
-            size_t pbc = serial_data_size;
-            // our display pointer
-            char* sz = display_text;
-            // null terminate it
-            *sz = '\0';
-            int cols = 0;
-            do {
-                if (pbc == 0) {
-                    break;
-                }
-                uint8_t b = *pb++;
-                --pbc;
-                char buf[4];
-                // format the binary column
-                // inserting spaces as necessary
-                if (bin_cols - 1 == cols) {
-                    snprintf(buf, sizeof(buf), "%02X", b);
-                    strcpy(sz, buf);
-                    sz += 2;
-                } else {
-                    snprintf(buf, sizeof(buf), "%02X ", b);
-                    strcpy(sz, buf);
-                    sz += 3;
-                }
-                // insert newlines as necessary
-                if (rows < probe_rows - 1 && ++cols == bin_cols) {
-                    cols = 0;
-                    *sz++ = '\n';
-                    ++rows;
-                }
-                // dump to the monitor
-                printf("%02X ", b);
-                if (++mon_cols == 10) {
-                    puts();
-                    mon_cols = 0;
-                }
-                ++advanced;
-            } while (--count_bin);
-            *sz = '\0';
-            puts("");
+            applied = true;
         }
-        // report a change
-        return true;
     }
-    // no change
-    return false;
-}
\ No newline at end of file
+    if (applied) {
+        probe_echo_i2c();
+    }
+    return changed || applied;
+}
@@ -0,0 +1,96 @@
+#include <hal.hpp>
+#include <monitor_out.hpp>
+#include <stdio.h>
+#include <string.h>
+
+monitor_out::monitor_out() : m_watermark(0),
+                             m_dropped(0),
+                             m_written(0),
+                             m_flushes(0) {
+}
+bool monitor_out::initialize(size_t capacity, size_t watermark) {
+    if (!m_buffer.initialize(capacity)) {
+        return false;
+    }
+    m_watermark = watermark;
+    m_dropped = 0;
+    m_written = 0;
+    m_flushes = 0;
+    return true;
+}
+size_t monitor_out::write(const void* data, size_t size) {
+    if (!m_buffer.initialized()) {
+        m_dropped += size;
+        return 0;
+    }
+    size_t result = m_buffer.write((const uint8_t*)data, size);
+    m_dropped += size - result;
+    if (m_buffer.size() >= m_watermark) {
+        flush();
+    }
+    return result;
+}
+size_t monitor_out::print(const char* text) {
+    return write(text, strlen(text));
+}
+size_t monitor_out::print(char ch) {
+    return write(&ch, 1);
+}
+size_t monitor_out::printf(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    size_t result = vprintf(format, args);
+    va_end(args);
+    return result;
+}
+size_t monitor_out::vprintf(const char* format, va_list args) {
+    char buf[128];
+    int len = vsnprintf(buf, sizeof(buf), format, args);
+    if (len < 0) {
+        return 0;
+    }
+    if ((size_t)len >= sizeof(buf)) {
+        // truncated
+        m_dropped += len - (sizeof(buf) - 1);
+        len = sizeof(buf) - 1;
+    }
+    return write(buf, len);
+}
+void monitor_out::flush() {
+    const uint8_t* spans[2];
+    size_t span_sizes[2];
+    m_buffer.peek(&spans[0], &span_sizes[0], &spans[1], &span_sizes[1]);
+    for (int s = 0; s < 2; ++s) {
+        if (span_sizes[s] == 0) {
+            break;
+        }
+        // only send what fits so we never block
+        int avail = MONITOR.availableForWrite();
+        if (avail <= 0) {
+            break;
+        }
+        size_t len = span_sizes[s];
+        if (len > (size_t)avail) {
+            len = (size_t)avail;
+        }
+        len = MONITOR.write(spans[s], len);
+        ++m_flushes;
+        m_written += len;
+        m_buffer.consume(len);
+        if (len < span_sizes[s]) {
+            break;
+        }
+    }
+}
+size_t monitor_out::size() const {
+    return m_buffer.size();
+}
+size_t monitor_out::dropped() const {
+    return m_dropped;
+}
+size_t monitor_out::written() const {
+    return m_written;
+}
+size_t monitor_out::flushes() const {
+    return m_flushes;
+}
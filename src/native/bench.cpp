@@ -0,0 +1,267 @@
+// host build of the probe pipeline. Replays a serial
+// capture and an i2c script through the formatter and
+// the UIX screen, and reports the throughput of each.
+// the monitor echo goes to stdout and the report to stderr
+// pio test builds the tests in test/ against src/, and
+// they bring their own main()
+#ifndef PIO_UNIT_TESTING
+#include <frame_stats.hpp>
+#include <hal.hpp>
+#include <i2c_scanner.hpp>
+#include <native/bench.hpp>
+#include <probe.hpp>
+#include <serial_capture.hpp>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ui.hpp>
+using namespace gfx;
+using namespace uix;
+
+using color32_t = color<rgba_pixel<32>>;
+
+// htcw_uix calls this to send a bitmap to the frame buffer
+static void uix_on_flush(const rect16& bounds,
+                         const void* bmp,
+                         void* state);
+
+// lcd panel data
+static constexpr const size_t lcd_buffer_size = gfx::bitmap<rgb_pixel<LCD_BIT_DEPTH>>::sizeof_buffer(LCD_WIDTH, LCD_HEIGHT / 5);
+static uint8_t* lcd_buffer1 = nullptr;
+
+// bench timings in microseconds
+static uint64_t serial_us = 0;
+static uint64_t i2c_us = 0;
+static uint64_t render_us = 0;
+// per drawn frame, like FRAME_STATS on the device
+static rolling_stat render_stat;
+static size_t serial_updates = 0;
+static size_t i2c_updates = 0;
+static size_t frames = 0;
+// schedules the i2c scans like i2c_update_task()
+static i2c_scanner i2c_scan;
+// set when an i2c event changed the address list
+static bool i2c_changed = false;
+
+// applies each address coming or going as it's seen,
+// like the probe thread does with the queued events
+static void i2c_on_event(const i2c_event_t& event, void* state) {
+    if (probe_apply_i2c(event.address, event.present)) {
+        i2c_changed = true;
+    }
+}
+static void usage(const char* exe) {
+    fprintf(stderr,
+            "Usage: %s [-s <serial file>] [-r <bytes/s>] [-l] [-b]\n"
+            "       [-i <i2c script>] [-t <seconds>] [-f <fps>]\n"
+            "       %s -H | -S | -L | -G | -A | -P <header>\n"
+            "  -s  file to replay into the serial probe\n"
+            "  -r  the rate to replay it at (default: baud/10)\n"
+            "  -l  loop the serial file\n"
+            "  -b  use binary mode\n"
+            "  -i  i2c bus script: lines of <ms> [address ...]\n"
+            "  -t  how long to run (default 10)\n"
+            "  -f  cap the frame rate (default uncapped)\n"
+            "  -H  run the hex dump microbenchmark\n"
+            "  -S  run the pixel byte swap microbenchmark\n"
+            "  -L  time the i2c address seqlock under contention\n"
+            "  -G  run the glyph cache benchmark\n"
+            "  -A  time the packed assets\n"
+            "  -P  write the packed assets header\n",
+            exe,
+            exe);
+}
+int main(int argc, char** argv) {
+    const char* serial_path = nullptr;
+    const char* i2c_path = nullptr;
+    uint32_t rate = 0;
+    bool loop = false;
+    uint32_t seconds = 10;
+    uint32_t fps = 0;
+    bool glyphs = false;
+    bool packed = false;
+    const char* pack_path = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const char* val = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (!strcmp(arg, "-s") && val) {
+            serial_path = val;
+            ++i;
+        } else if (!strcmp(arg, "-r") && val) {
+            rate = (uint32_t)strtoul(val, nullptr, 0);
+            ++i;
+        } else if (!strcmp(arg, "-i") && val) {
+            i2c_path = val;
+            ++i;
+        } else if (!strcmp(arg, "-t") && val) {
+            seconds = (uint32_t)strtoul(val, nullptr, 0);
+            ++i;
+        } else if (!strcmp(arg, "-f") && val) {
+            fps = (uint32_t)strtoul(val, nullptr, 0);
+            ++i;
+        } else if (!strcmp(arg, "-l")) {
+            loop = true;
+        } else if (!strcmp(arg, "-b")) {
+            serial_bin = true;
+        } else if (!strcmp(arg, "-H")) {
+            return bench_hex();
+        } else if (!strcmp(arg, "-S")) {
+            return bench_swap();
+        } else if (!strcmp(arg, "-L")) {
+            return bench_seqlock();
+        } else if (!strcmp(arg, "-G")) {
+            glyphs = true;
+        } else if (!strcmp(arg, "-A")) {
+            packed = true;
+        } else if (!strcmp(arg, "-P") && val) {
+            pack_path = val;
+            ++i;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    MONITOR.begin(115200);
+    if (serial_path != nullptr && !sim_ser.open(serial_path, rate, loop)) {
+        fprintf(stderr, "Could not open %s\n", serial_path);
+        return 1;
+    }
+    if (i2c_path != nullptr && !sim_i2c.script(i2c_path)) {
+        fprintf(stderr, "Could not open %s\n", i2c_path);
+        return 1;
+    }
+    sim_i2c.rewind();
+    lcd_buffer1 = (uint8_t*)malloc(lcd_buffer_size);
+    if (lcd_buffer1 == nullptr) {
+        fputs("Out of memory allocating lcd_buffer1\n", stderr);
+        return 1;
+    }
+    sim_fb.initialize(LCD_WIDTH, LCD_HEIGHT, LCD_BIT_DEPTH);
+    main_screen.dimensions({LCD_WIDTH, LCD_HEIGHT});
+    main_screen.buffer_size(lcd_buffer_size);
+    main_screen.buffer1(lcd_buffer1);
+    main_screen.on_flush_callback(uix_on_flush);
+    ui_init();
+    if (!probe_init()) {
+        return 1;
+    }
+    if (glyphs) {
+        return bench_glyphs();
+    }
+    if (packed) {
+        return bench_packed();
+    }
+    if (pack_path != nullptr) {
+        return pack_assets(pack_path);
+    }
+    if (!serial_capture_begin(serial_bauds[serial_baud_index], SERIAL_CAPTURE_SIZE)) {
+        fputs("Could not start serial capture\n", stderr);
+        return 1;
+    }
+    i2c_scan.on_event_callback(i2c_on_event);
+    uint32_t start_ms = millis();
+    uint32_t frame_us = fps ? 1000000 / fps : 0;
+    while (millis() - start_ms < seconds * 1000) {
+        uint32_t frame_ts = micros();
+        uint32_t ts;
+        // poll and sweep the bus like i2c_update_task()
+        ts = micros();
+        i2c_scan.update(millis());
+        i2c_us += micros() - ts;
+        if (i2c_changed) {
+            i2c_changed = false;
+            probe_echo_i2c();
+            ++i2c_updates;
+            probe_show_i2c();
+            probe_painter.visible(true);
+            probe_label.color(color32_t::green);
+            probe_label.text(display_text);
+            probe_label.visible(true);
+        }
+        ts = micros();
+        bool changed = probe_refresh_serial();
+        serial_us += micros() - ts;
+        // like probe_task(), drain what's left of a burst
+        if (probe_monitor.size()) {
+            probe_monitor.flush();
+        }
+        if (changed) {
+            ++serial_updates;
+            probe_show_serial();
+            probe_painter.visible(true);
+            probe_label.color(color32_t::yellow);
+            probe_label.text(display_text);
+            probe_label.visible(true);
+        }
+        size_t flushes = sim_fb.flushes();
+        ts = micros();
+        main_screen.update();
+        uint32_t update_us = micros() - ts;
+        render_us += update_us;
+        if (sim_fb.flushes() != flushes) {
+            ++frames;
+            render_stat.add(update_us);
+        }
+        if (serial_path != nullptr && sim_ser.eof() &&
+            serial_capture_buffer().empty() && !loop) {
+            break;
+        }
+        // like render_task(), sleep off the rest of the frame
+        uint32_t frame_elapsed = micros() - frame_ts;
+        if (frame_elapsed < frame_us) {
+            delay((frame_us - frame_elapsed) / 1000);
+        }
+    }
+    double elapsed = (millis() - start_ms) / 1000.0;
+    serial_capture_end();
+    serial_capture_stats_t stats;
+    serial_capture_statistics(&stats);
+    size_t serial_bytes = stats.received - serial_capture_buffer().size();
+    fprintf(stderr, "elapsed: %0.2fs\n", elapsed);
+    fprintf(stderr, "serial: %zu bytes at the pin, %zu captured, %zu overflowed, %zu dropped\n",
+            sim_ser.received(), stats.received, stats.overflowed, stats.dropped);
+    fprintf(stderr, "serial: %zu updates, %0.1f bytes/s formatted, %0.1fus/update\n",
+            serial_updates,
+            serial_us ? serial_bytes * 1000000.0 / serial_us : 0.0,
+            serial_updates ? (double)serial_us / serial_updates : 0.0);
+    fprintf(stderr, "monitor: %zu bytes in %zu writes, %zu dropped\n",
+            probe_monitor.written(), probe_monitor.flushes(), probe_monitor.dropped());
+    fprintf(stderr, "i2c: %zu probes, %zu updates, %0.1fms simulated bus time\n",
+            sim_i2c.probes(), i2c_updates, sim_i2c.bus_us() / 1000.0);
+    fprintf(stderr, "i2c: %zu sweeps, %zu polls, %zu failed, last sweep period %ums\n",
+            i2c_scan.sweeps(), i2c_scan.polls(), i2c_scan.failures(), (unsigned)i2c_scan.sweep_ms());
+    if (i2c_scan.latency().count()) {
+        fprintf(stderr, "i2c: %zu changes, seen within p50 %ums, p95 %ums, max %ums\n",
+                i2c_scan.changes(),
+                (unsigned)i2c_scan.latency().percentile(50),
+                (unsigned)i2c_scan.latency().percentile(95),
+                (unsigned)i2c_scan.latency().max());
+    }
+    fprintf(stderr, "i2c: %zu driver installs in %uus, %zu bus errors\n",
+            probe_i2c_session.inits(), (unsigned)probe_i2c_session.init_us(), probe_i2c_session.errors());
+    fprintf(stderr, "render: %zu frames, %0.1f frames/s, %0.1fus/frame\n",
+            frames,
+            render_us ? frames * 1000000.0 / render_us : 0.0,
+            frames ? (double)render_us / frames : 0.0);
+    fprintf(stderr, "render: last %zu frames p50 %uus, p95 %uus, max %uus\n",
+            render_stat.count(),
+            (unsigned)render_stat.percentile(50),
+            (unsigned)render_stat.percentile(95),
+            (unsigned)render_stat.max());
+    fprintf(stderr, "flush: %zu bitmaps, %llu bytes\n",
+            sim_fb.flushes(), (unsigned long long)sim_fb.bytes());
+    return 0;
+}
+// writes bitmap data to the frame buffer
+static void uix_on_flush(const rect16& bounds,
+                         const void* bmp,
+                         void* state) {
+    sim_fb.draw_bitmap(bounds.x1,
+                       bounds.y1,
+                       bounds.x2,
+                       bounds.y2,
+                       bmp);
+    // there's no DMA so the flush is already complete
+    main_screen.flush_complete();
+}
+#endif
@@ -0,0 +1,83 @@
+#include <lcd_config.h>
+#include <native/bench.hpp>
+#include <native/sim_hal.hpp>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ui.hpp>
+using namespace gfx;
+using namespace uix;
+
+using color32_t = color<rgba_pixel<32>>;
+
+// frames to render per font
+static const size_t bench_glyphs_frames = 100;
+
+// fills a screen of probe text, shifted by frame
+// so every frame is a full redraw like a scroll
+static void bench_glyphs_text(char* out_text, size_t frame) {
+    char* sz = out_text;
+    for (int y = 0; y < probe_rows; ++y) {
+        if (y) {
+            *sz++ = '\n';
+        }
+        for (int x = 0; x < probe_cols; ++x) {
+            *sz++ = (char)(' ' + 1 + (frame + y * probe_cols + x) % 94);
+        }
+    }
+    *sz = '\0';
+}
+// renders the frames with the probe label
+// in the given font, returning the mean
+// frame time in microseconds
+static double bench_glyphs_run(font& fnt, char* text) {
+    probe_label.font(fnt);
+    uint64_t total_us = 0;
+    for (size_t i = 0; i < bench_glyphs_frames; ++i) {
+        bench_glyphs_text(text, i);
+        probe_label.text(text);
+        probe_label.invalidate();
+        uint32_t ts = micros();
+        main_screen.update();
+        total_us += micros() - ts;
+    }
+    return (double)total_us / bench_glyphs_frames;
+}
+int bench_glyphs() {
+    const size_t size = LCD_WIDTH * LCD_HEIGHT * ((LCD_BIT_DEPTH + 7) / 8);
+    char* text = (char*)malloc(probe_cols * (probe_rows + 1) + 1);
+    uint8_t* frame1 = (uint8_t*)malloc(size);
+    if (text == nullptr || frame1 == nullptr) {
+        fputs("Out of memory\n", stderr);
+        return 1;
+    }
+    probe_painter.visible(true);
+    probe_label.color(color32_t::yellow);
+    probe_label.visible(true);
+    int result = 0;
+    // the cache must not change what's drawn
+    bench_glyphs_text(text, 0);
+    probe_label.text(text);
+    probe_label.font(probe_font);
+    main_screen.update();
+    memcpy(frame1, sim_fb.data(), size);
+    probe_label.font(probe_font_cache);
+    probe_label.invalidate();
+    main_screen.update();
+    if (memcmp(frame1, sim_fb.data(), size)) {
+        fputs("glyphs: cached output differs from the font\n", stderr);
+        result = 1;
+    }
+    probe_font_cache.clear();
+    double old_us = bench_glyphs_run(probe_font, text);
+    double new_us = bench_glyphs_run(probe_font_cache, text);
+    fprintf(stderr, "glyphs: %dx%d cells, %zu glyph atlas\n",
+            (int)probe_cols, (int)probe_rows, probe_font_cache.capacity());
+    fprintf(stderr, "glyphs: tt_font %0.0fus/frame, cached %0.0fus/frame, %0.1fx\n",
+            old_us, new_us, old_us / new_us);
+    fprintf(stderr, "glyphs: %zu hits, %zu misses, %zu evictions\n",
+            probe_font_cache.hits(), probe_font_cache.misses(), probe_font_cache.evictions());
+    free(text);
+    free(frame1);
+    return result;
+}
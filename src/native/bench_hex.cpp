@@ -0,0 +1,101 @@
+#include <hex_dump.hpp>
+#include <native/bench.hpp>
+#include <native/sim_hal.hpp>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// bytes per row, as in the probe's binary display
+static const size_t bench_hex_cols = 16;
+
+// the binary display formatting as it was
+// done per byte with snprintf()
+static size_t bench_hex_snprintf(const uint8_t* data, size_t size, char* out_text) {
+    char* sz = out_text;
+    size_t cols = 0;
+    while (size--) {
+        char buf[4];
+        if (bench_hex_cols - 1 == cols) {
+            snprintf(buf, sizeof(buf), "%02X", *data++);
+            strcpy(sz, buf);
+            sz += 2;
+        } else {
+            snprintf(buf, sizeof(buf), "%02X ", *data++);
+            strcpy(sz, buf);
+            sz += 3;
+        }
+        if (++cols == bench_hex_cols) {
+            cols = 0;
+            *sz++ = '\n';
+        }
+    }
+    return sz - out_text;
+}
+// the same output from the table driven kernel
+static size_t bench_hex_table(const uint8_t* data, size_t size, char* out_text) {
+    char* sz = out_text;
+    while (size) {
+        size_t run = size < bench_hex_cols ? size : bench_hex_cols;
+        sz += hex_dump_row(data, run, sz);
+        if (run == bench_hex_cols) {
+            *sz++ = '\n';
+        } else {
+            // match the trailing space of a partial row
+            *sz++ = ' ';
+        }
+        data += run;
+        size -= run;
+    }
+    return sz - out_text;
+}
+// runs fn over the data until at least 200ms
+// has elapsed, returning MB/s
+static double bench_hex_run(size_t (*fn)(const uint8_t*, size_t, char*),
+                            const uint8_t* data,
+                            size_t size,
+                            char* out_text) {
+    size_t iterations = 0;
+    uint32_t start = micros();
+    uint32_t elapsed;
+    do {
+        fn(data, size, out_text);
+        ++iterations;
+        elapsed = micros() - start;
+    } while (elapsed < 200000);
+    return (double)size * iterations / elapsed;
+}
+int bench_hex() {
+    static const size_t sizes[] = {1024, 64 * 1024, 1024 * 1024};
+    const size_t max_size = sizes[sizeof(sizes) / sizeof(size_t) - 1];
+    uint8_t* data = (uint8_t*)malloc(max_size);
+    char* text1 = (char*)malloc(max_size * 4);
+    char* text2 = (char*)malloc(max_size * 4);
+    if (data == nullptr || text1 == nullptr || text2 == nullptr) {
+        fputs("Out of memory\n", stderr);
+        return 1;
+    }
+    srand(1);
+    for (size_t i = 0; i < max_size; ++i) {
+        data[i] = (uint8_t)rand();
+    }
+    int result = 0;
+    fputs("hex dump: size, snprintf MB/s, table MB/s, speedup\n", stderr);
+    for (size_t size : sizes) {
+        // make sure they agree first
+        size_t len1 = bench_hex_snprintf(data, size, text1);
+        size_t len2 = bench_hex_table(data, size, text2);
+        if (len1 != len2 || memcmp(text1, text2, len1)) {
+            fprintf(stderr, "hex dump: output mismatch at %zu bytes\n", size);
+            result = 1;
+            continue;
+        }
+        double old_mbs = bench_hex_run(bench_hex_snprintf, data, size, text1);
+        double new_mbs = bench_hex_run(bench_hex_table, data, size, text2);
+        fprintf(stderr, "%zuKB, %0.1f, %0.1f, %0.1fx\n",
+                size / 1024, old_mbs, new_mbs, new_mbs / old_mbs);
+    }
+    free(data);
+    free(text1);
+    free(text2);
+    return result;
+}
@@ -0,0 +1,63 @@
+#include <native/bench.hpp>
+#include <native/sim_hal.hpp>
+#include <seqlock.hpp>
+#include <stdio.h>
+
+#include <atomic>
+#include <thread>
+
+// the i2c address bitmap
+struct bench_seqlock_value {
+    uint32_t banks[4];
+};
+static const size_t bench_seqlock_readers = 3;
+static const uint32_t bench_seqlock_ms = 2000;
+
+static seqlock<bench_seqlock_value> bench_seqlock_shared;
+static std::atomic_bool bench_seqlock_done(false);
+
+static void bench_seqlock_write(size_t* out_writes) {
+    bench_seqlock_value value;
+    size_t writes = 0;
+    while (!bench_seqlock_done) {
+        ++writes;
+        for (int i = 0; i < 4; ++i) {
+            value.banks[i] = (uint32_t)writes;
+        }
+        bench_seqlock_shared.write(value);
+    }
+    *out_writes = writes;
+}
+static void bench_seqlock_read(size_t* out_reads) {
+    size_t reads = 0;
+    while (!bench_seqlock_done) {
+        bench_seqlock_value value;
+        bench_seqlock_shared.read(&value);
+        ++reads;
+    }
+    *out_reads = reads;
+}
+// test/test_seqlock checks the reads. this only times them
+int bench_seqlock() {
+    size_t reads[bench_seqlock_readers];
+    std::thread reader_threads[bench_seqlock_readers];
+    size_t writes = 0;
+    for (size_t i = 0; i < bench_seqlock_readers; ++i) {
+        reader_threads[i] = std::thread(bench_seqlock_read, &reads[i]);
+    }
+    std::thread writer_thread(bench_seqlock_write, &writes);
+    delay(bench_seqlock_ms);
+    bench_seqlock_done = true;
+    writer_thread.join();
+    size_t total_reads = 0;
+    for (size_t i = 0; i < bench_seqlock_readers; ++i) {
+        reader_threads[i].join();
+        total_reads += reads[i];
+    }
+    const double ns = bench_seqlock_ms * 1000000.0;
+    fprintf(stderr, "seqlock: 1 writer, %zu readers for %ums\n", bench_seqlock_readers, (unsigned)bench_seqlock_ms);
+    fprintf(stderr, "seqlock: %zu writes, %0.1fns/write\n", writes, writes ? ns / writes : 0.0);
+    fprintf(stderr, "seqlock: %zu reads, %0.1fns/read per reader\n",
+            total_reads, total_reads ? ns * bench_seqlock_readers / total_reads : 0.0);
+    return 0;
+}
@@ -0,0 +1,153 @@
+#include <lcd_config.h>
+#include <native/bench.hpp>
+#include <native/sim_hal.hpp>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// a full frame of 16-bit pixels
+static const size_t bench_swap_pixels = (size_t)LCD_WIDTH * LCD_HEIGHT;
+
+// the in place swap lcd_panel_draw_bitmap() does per pixel
+static void bench_swap_pixel(uint16_t* data, const uint16_t* src) {
+    for (size_t i = 0; i < bench_swap_pixels; ++i) {
+        uint16_t* p = &data[i];
+        *p = ((*p << 8) & 0xFF00) | ((*p >> 8) & 0xFF);
+    }
+}
+// the byte by byte copy into the RGB panel's lines
+static void bench_swap_copy_pixel(uint16_t* data, const uint16_t* src) {
+    uint8_t* dst = (uint8_t*)data;
+    const uint8_t* s = (const uint8_t*)src;
+    for (size_t x = 0; x < bench_swap_pixels * 2; x += 2) {
+        dst[x] = s[x + 1];
+        dst[x + 1] = s[x];
+    }
+}
+// the candidate: two pixels per 32-bit word, unrolled
+static inline uint32_t bench_swap_word(uint32_t value) {
+    return ((value & 0x00FF00FFu) << 8) | ((value >> 8) & 0x00FF00FFu);
+}
+static inline uint16_t bench_swap_half(uint16_t value) {
+    return (uint16_t)((value << 8) | (value >> 8));
+}
+static void bench_swap_words(uint16_t* data, size_t count) {
+    uint16_t* p = data;
+    // get to a word boundary
+    if (((uintptr_t)p & 3) && count) {
+        *p = bench_swap_half(*p);
+        ++p;
+        --count;
+    }
+    uint32_t* pw = (uint32_t*)p;
+    size_t words = count >> 1;
+    while (words >= 4) {
+        pw[0] = bench_swap_word(pw[0]);
+        pw[1] = bench_swap_word(pw[1]);
+        pw[2] = bench_swap_word(pw[2]);
+        pw[3] = bench_swap_word(pw[3]);
+        pw += 4;
+        words -= 4;
+    }
+    while (words--) {
+        *pw = bench_swap_word(*pw);
+        ++pw;
+    }
+    if (count & 1) {
+        p = (uint16_t*)pw;
+        *p = bench_swap_half(*p);
+    }
+}
+// words are used when both pointers share the same alignment
+static void bench_swap_copy_words(uint16_t* d, const uint16_t* s, size_t count) {
+    if ((((uintptr_t)d ^ (uintptr_t)s) & 3) == 0) {
+        if (((uintptr_t)d & 3) && count) {
+            *d++ = bench_swap_half(*s++);
+            --count;
+        }
+        uint32_t* dw = (uint32_t*)d;
+        const uint32_t* sw = (const uint32_t*)s;
+        size_t words = count >> 1;
+        while (words >= 4) {
+            dw[0] = bench_swap_word(sw[0]);
+            dw[1] = bench_swap_word(sw[1]);
+            dw[2] = bench_swap_word(sw[2]);
+            dw[3] = bench_swap_word(sw[3]);
+            dw += 4;
+            sw += 4;
+            words -= 4;
+        }
+        while (words--) {
+            *dw++ = bench_swap_word(*sw++);
+        }
+        d = (uint16_t*)dw;
+        s = (const uint16_t*)sw;
+        count &= 1;
+    }
+    while (count--) {
+        *d++ = bench_swap_half(*s++);
+    }
+}
+static void bench_swap_word_run(uint16_t* data, const uint16_t* src) {
+    bench_swap_words(data, bench_swap_pixels);
+}
+static void bench_swap_copy_word_run(uint16_t* data, const uint16_t* src) {
+    bench_swap_copy_words(data, src, bench_swap_pixels);
+}
+// runs fn until at least 200ms has elapsed,
+// returning microseconds per frame
+static double bench_swap_run(void (*fn)(uint16_t*, const uint16_t*),
+                             uint16_t* data,
+                             const uint16_t* src) {
+    size_t iterations = 0;
+    uint32_t start = micros();
+    uint32_t elapsed;
+    do {
+        fn(data, src);
+        ++iterations;
+        elapsed = micros() - start;
+    } while (elapsed < 200000);
+    return (double)elapsed / iterations;
+}
+int bench_swap() {
+    uint16_t* src = (uint16_t*)malloc(bench_swap_pixels * 2);
+    uint16_t* data1 = (uint16_t*)malloc(bench_swap_pixels * 2);
+    uint16_t* data2 = (uint16_t*)malloc(bench_swap_pixels * 2);
+    if (src == nullptr || data1 == nullptr || data2 == nullptr) {
+        fputs("Out of memory\n", stderr);
+        return 1;
+    }
+    srand(1);
+    for (size_t i = 0; i < bench_swap_pixels; ++i) {
+        src[i] = (uint16_t)rand();
+    }
+    int result = 0;
+    // make sure they agree first, including
+    // from an odd pixel like a clipped strip
+    for (size_t offs = 0; offs < 2; ++offs) {
+        memcpy(data1, src, bench_swap_pixels * 2);
+        memcpy(data2, src, bench_swap_pixels * 2);
+        bench_swap_pixel(data1, nullptr);
+        bench_swap_words(data2 + offs, bench_swap_pixels - offs);
+        if (memcmp(data1 + offs, data2 + offs, (bench_swap_pixels - offs) * 2)) {
+            fputs("swap: in place output mismatch\n", stderr);
+            result = 1;
+        }
+        bench_swap_copy_words(data2 + offs, src + offs, bench_swap_pixels - offs);
+        if (memcmp(data1 + offs, data2 + offs, (bench_swap_pixels - offs) * 2)) {
+            fputs("swap: copy output mismatch\n", stderr);
+            result = 1;
+        }
+    }
+    double pixel_us = bench_swap_run(bench_swap_pixel, data1, src);
+    double word_us = bench_swap_run(bench_swap_word_run, data2, src);
+    double copy_pixel_us = bench_swap_run(bench_swap_copy_pixel, data1, src);
+    double copy_word_us = bench_swap_run(bench_swap_copy_word_run, data2, src);
+    fprintf(stderr, "swap: %dx%d frame, us/frame per pixel, per word, speedup\n", (int)LCD_WIDTH, (int)LCD_HEIGHT);
+    fprintf(stderr, "in place, %0.1f, %0.1f, %0.1fx\n", pixel_us, word_us, pixel_us / word_us);
+    fprintf(stderr, "copy, %0.1f, %0.1f, %0.1fx\n", copy_pixel_us, copy_word_us, copy_pixel_us / copy_word_us);
+    free(src);
+    free(data1);
+    free(data2);
+    return result;
+}
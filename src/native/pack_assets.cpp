@@ -0,0 +1,375 @@
+// the asset compiler. Rasterizes the fonts and the title
+// SVG through the same gfx code the firmware uses, so the
+// tables decode to exactly the pixels the TrueType and SVG
+// paths draw, and writes them out as a header.
+// tools/pack_assets.py runs it when building with PACKED_ASSETS
+#include <lcd_config.h>
+#include <native/bench.hpp>
+#include <native/sim_hal.hpp>
+#include <packed_font.hpp>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ui.hpp>
+
+#include <algorithm>
+#include <vector>
+using namespace gfx;
+using namespace uix;
+
+using color32_t = color<rgba_pixel<32>>;
+
+// a font subset being packed
+struct pack_font {
+    // the C name of the table
+    const char* name;
+    ui_font_t* font;
+    // the characters used with it. nullptr
+    // for all of printable ASCII
+    const char* chars;
+    std::vector<packed_glyph_t> glyphs;
+    std::vector<packed_kern_t> kerns;
+    std::vector<uint8_t> data;
+    packed_font_data_t packed;
+};
+// a pre-rendered image being packed
+struct pack_image {
+    const char* name;
+    std::vector<uint8_t> pixels;
+    std::vector<uint8_t> data;
+    packed_image_data_t packed;
+};
+
+// the sizes and characters ui.cpp and main.cpp use.
+// probe text is arbitrary serial data so it gets all
+// of printable ASCII
+static pack_font pack_fonts[] = {
+    {"title_packed_font", &title_font, "i2cu"},
+    {"probe_msg_packed_font", &probe_msg_font, "[ mode ][ baud ][ paused ]"},
+    {"probe_packed_font", &probe_font, nullptr}};
+static const size_t pack_fonts_size = sizeof(pack_fonts) / sizeof(pack_font);
+static pack_image pack_title = {"title_packed_image"};
+
+// appends the runs for a w by h bitmap, a row at a time
+static void pack_rows(const uint8_t* pixels, size_t unit, int w, int h, std::vector<uint8_t>* out_data) {
+    std::vector<uint8_t> row(w * unit + w / 128 + 1);
+    for (int y = 0; y < h; ++y) {
+        size_t len = packed_encode(pixels + (size_t)y * w * unit, unit, w, row.data());
+        out_data->insert(out_data->end(), row.begin(), row.begin() + len);
+    }
+}
+static bool pack_build_font(pack_font& pf) {
+    std::vector<int32_t> cps;
+    if (pf.chars == nullptr) {
+        for (int32_t cp = 32; cp < 127; ++cp) {
+            cps.push_back(cp);
+        }
+    } else {
+        for (const char* sz = pf.chars; *sz; ++sz) {
+            bool found = false;
+            for (int32_t cp : cps) {
+                found = found || cp == *sz;
+            }
+            if (!found) {
+                cps.push_back(*sz);
+            }
+        }
+        std::sort(cps.begin(), cps.end());
+    }
+    pf.glyphs.clear();
+    pf.kerns.clear();
+    pf.data.clear();
+    std::vector<uint8_t> pixels;
+    for (int32_t cp : cps) {
+        font_glyph_info gi;
+        if (gfx_result::success != pf.font->on_measure(cp, -1, &gi)) {
+            fprintf(stderr, "pack: %s has no glyph for %d\n", pf.name, (int)cp);
+            return false;
+        }
+        packed_glyph_t g;
+        g.codepoint = cp;
+        g.width = gi.dimensions.width;
+        g.height = gi.dimensions.height;
+        g.offset_x = (int16_t)gi.offset.x;
+        g.offset_y = (int16_t)gi.offset.y;
+        g.advance = (int16_t)gi.advance_width;
+        g.data = (uint32_t)pf.data.size();
+        if (g.width && g.height) {
+            pixels.assign((size_t)g.width * g.height, 0);
+            bitmap<alpha_pixel<8>> bmp(size16(g.width, g.height), pixels.data());
+            if (gfx_result::success != pf.font->on_draw(bmp, cp, gi.glyph_index1)) {
+                fprintf(stderr, "pack: %s could not draw %d\n", pf.name, (int)cp);
+                return false;
+            }
+            pack_rows(pixels.data(), 1, g.width, g.height, &pf.data);
+        }
+        pf.glyphs.push_back(g);
+    }
+    // keep the pairs whose advance differs from
+    // the glyph's own. cps is sorted so these are too
+    for (const packed_glyph_t& g : pf.glyphs) {
+        for (int32_t cp2 : cps) {
+            font_glyph_info gi;
+            if (gfx_result::success == pf.font->on_measure(g.codepoint, cp2, &gi) &&
+                gi.advance_width != g.advance) {
+                packed_kern_t k;
+                k.codepoint1 = g.codepoint;
+                k.codepoint2 = cp2;
+                k.adjust = (int16_t)(gi.advance_width - g.advance);
+                pf.kerns.push_back(k);
+            }
+        }
+    }
+    pf.packed.line_height = pf.font->line_height();
+    pf.packed.line_advance = pf.font->line_advance();
+    pf.packed.base_line = pf.font->base_line();
+    pf.packed.glyph_count = (uint16_t)pf.glyphs.size();
+    pf.packed.glyphs = pf.glyphs.data();
+    pf.packed.kern_count = (uint16_t)pf.kerns.size();
+    pf.packed.kerns = pf.kerns.empty() ? nullptr : pf.kerns.data();
+    pf.packed.data = pf.data.data();
+    return true;
+}
+// renders the SVG at its size on the title the
+// same way svg_box does
+static bool pack_render_title(size16 size, std::vector<uint8_t>* out_pixels) {
+    using bmp_type = bitmap<rgba_pixel<32>>;
+    out_pixels->assign(bmp_type::sizeof_buffer(size), 0);
+    bmp_type bmp(size, out_pixels->data());
+    bmp.fill(bmp.bounds(), rgba_pixel<32>(0, true));
+    sizef dim;
+    probe_stm.seek(0);
+    if (gfx_result::success != canvas::svg_dimensions(probe_stm, &dim)) {
+        return false;
+    }
+    matrix transform = matrix::create_fit_to(dim, (rectf)title_svg.bounds());
+    canvas cv(size);
+    if (gfx_result::success != draw::canvas(bmp, cv)) {
+        return false;
+    }
+    probe_stm.seek(0);
+    gfx_result res = cv.render_svg(probe_stm, transform);
+    cv.deinitialize();
+    return res == gfx_result::success;
+}
+static bool pack_build_image(pack_image& pi) {
+    const size16 size = (size16)title_svg.bounds().dimensions();
+    if (size.width > 256 || !pack_render_title(size, &pi.pixels)) {
+        fputs("pack: could not render the title SVG\n", stderr);
+        return false;
+    }
+    pi.data.clear();
+    pack_rows(pi.pixels.data(), 4, size.width, size.height, &pi.data);
+    pi.packed.width = size.width;
+    pi.packed.height = size.height;
+    pi.packed.data = pi.data.data();
+    return true;
+}
+bool pack_build() {
+    for (size_t i = 0; i < pack_fonts_size; ++i) {
+        if (!pack_build_font(pack_fonts[i])) {
+            return false;
+        }
+    }
+    return pack_build_image(pack_title);
+}
+static void pack_write_bytes(FILE* file, const char* name, const std::vector<uint8_t>& data) {
+    fprintf(file, "static const uint8_t %s_data[] = {", name);
+    for (size_t i = 0; i < data.size(); ++i) {
+        fprintf(file, "%s0x%02x,", (i % 16) ? "" : "\n\t", data[i]);
+    }
+    fputs("\n};\n", file);
+}
+int pack_assets(const char* path) {
+    if (!pack_build()) {
+        return 1;
+    }
+    FILE* file = fopen(path, "w");
+    if (file == nullptr) {
+        fprintf(stderr, "pack: could not open %s\n", path);
+        return 1;
+    }
+    fputs("// Generated by the native program (-P) from the assets\n"
+          "// in this folder. Do not edit. See tools/pack_assets.py\n"
+          "// --------------------------------------------------------\n"
+          "// Add #define PACKED_ASSETS_IMPLEMENTATION\n"
+          "// to exactly one CPP file before including this file.\n"
+          "// --------------------------------------------------------\n\n"
+          "#ifndef PACKED_ASSETS_H\n"
+          "#define PACKED_ASSETS_H\n"
+          "#include <packed_font.hpp>\n\n",
+          file);
+    for (size_t i = 0; i < pack_fonts_size; ++i) {
+        fprintf(file, "extern const packed_font_data_t %s;\n", pack_fonts[i].name);
+    }
+    fprintf(file, "extern const packed_image_data_t %s;\n", pack_title.name);
+    fputs("#endif\n\n#ifdef PACKED_ASSETS_IMPLEMENTATION\n\n", file);
+    size_t total = 0;
+    for (size_t i = 0; i < pack_fonts_size; ++i) {
+        const pack_font& pf = pack_fonts[i];
+        pack_write_bytes(file, pf.name, pf.data);
+        fprintf(file, "static const packed_glyph_t %s_glyphs[] = {", pf.name);
+        for (const packed_glyph_t& g : pf.glyphs) {
+            fprintf(file, "\n\t{%d,%u,%u,%d,%d,%d,%u},",
+                    (int)g.codepoint, g.width, g.height, g.offset_x, g.offset_y, g.advance, (unsigned)g.data);
+        }
+        fputs("\n};\n", file);
+        if (!pf.kerns.empty()) {
+            fprintf(file, "static const packed_kern_t %s_kerns[] = {", pf.name);
+            for (const packed_kern_t& k : pf.kerns) {
+                fprintf(file, "\n\t{%d,%d,%d},", (int)k.codepoint1, (int)k.codepoint2, k.adjust);
+            }
+            fputs("\n};\n", file);
+        }
+        fprintf(file, "const packed_font_data_t %s = {%u,%u,%u,%u,%s_glyphs,%u,",
+                pf.name,
+                pf.packed.line_height,
+                pf.packed.line_advance,
+                pf.packed.base_line,
+                pf.packed.glyph_count,
+                pf.name,
+                pf.packed.kern_count);
+        if (pf.kerns.empty()) {
+            fputs("nullptr,", file);
+        } else {
+            fprintf(file, "%s_kerns,", pf.name);
+        }
+        fprintf(file, "%s_data};\n\n", pf.name);
+        size_t size = pf.data.size() + pf.glyphs.size() * sizeof(packed_glyph_t) +
+                      pf.kerns.size() * sizeof(packed_kern_t);
+        fprintf(stderr, "pack: %s, %zu glyphs, %zu kerns, %zu bytes\n",
+                pf.name, pf.glyphs.size(), pf.kerns.size(), size);
+        total += size;
+    }
+    pack_write_bytes(file, pack_title.name, pack_title.data);
+    fprintf(file, "const packed_image_data_t %s = {%u,%u,%s_data};\n\n",
+            pack_title.name, pack_title.packed.width, pack_title.packed.height, pack_title.name);
+    fprintf(stderr, "pack: %s, %ux%u, %zu bytes\n",
+            pack_title.name, pack_title.packed.width, pack_title.packed.height, pack_title.data.size());
+    total += pack_title.data.size();
+    fputs("#endif\n", file);
+    fclose(file);
+    fprintf(stderr, "pack: %zu bytes total\n", total);
+    return 0;
+}
+
+// fills out_text with a screen full of probe text, every
+// printable character in turn, and shows the probe label
+static void pack_screen_text(std::vector<char>* out_text) {
+    out_text->assign(probe_cols * (probe_rows + 1) + 1, '\0');
+    char* sz = out_text->data();
+    for (int y = 0; y < probe_rows; ++y) {
+        if (y) {
+            *sz++ = '\n';
+        }
+        for (int x = 0; x < probe_cols; ++x) {
+            *sz++ = (char)(' ' + 1 + (y * probe_cols + x) % 94);
+        }
+    }
+    *sz = '\0';
+    probe_painter.visible(true);
+    probe_label.color(color32_t::yellow);
+    probe_label.visible(true);
+}
+size_t pack_glyph_mismatches() {
+    size_t mismatches = 0;
+    std::vector<uint8_t> expected;
+    std::vector<uint8_t> actual;
+    for (size_t i = 0; i < pack_fonts_size; ++i) {
+        pack_font& pf = pack_fonts[i];
+        packed_font pfont(pf.packed);
+        for (const packed_glyph_t& g : pf.glyphs) {
+            font_glyph_info gi1, gi2;
+            pf.font->on_measure(g.codepoint, -1, &gi1);
+            pfont.on_measure(g.codepoint, -1, &gi2);
+            if (gi1.dimensions.width != gi2.dimensions.width ||
+                gi1.dimensions.height != gi2.dimensions.height ||
+                gi1.advance_width != gi2.advance_width) {
+                fprintf(stderr, "packed: %s %d measured differently\n", pf.name, (int)g.codepoint);
+                ++mismatches;
+                continue;
+            }
+            size16 size(g.width, g.height);
+            expected.assign((size_t)g.width * g.height, 0);
+            actual.assign((size_t)g.width * g.height, 0xFF);
+            if (g.width && g.height) {
+                bitmap<alpha_pixel<8>> e(size, expected.data());
+                bitmap<alpha_pixel<8>> a(size, actual.data());
+                pf.font->on_draw(e, g.codepoint, gi1.glyph_index1);
+                pfont.on_draw(a, g.codepoint, gi2.glyph_index1);
+                if (memcmp(expected.data(), actual.data(), expected.size())) {
+                    fprintf(stderr, "packed: %s %d drew differently\n", pf.name, (int)g.codepoint);
+                    ++mismatches;
+                }
+            }
+        }
+    }
+    return mismatches;
+}
+bool pack_title_matches() {
+    std::vector<uint8_t> actual(pack_title.pixels.size(), 0);
+    packed_decode(pack_title.packed.data, 4, (size_t)pack_title.packed.width * pack_title.packed.height, actual.data());
+    std::vector<uint8_t> svg;
+    if (!pack_render_title(size16(pack_title.packed.width, pack_title.packed.height), &svg)) {
+        return false;
+    }
+    return svg == actual;
+}
+bool pack_screen_matches() {
+    const size_t size = LCD_WIDTH * LCD_HEIGHT * ((LCD_BIT_DEPTH + 7) / 8);
+    std::vector<char> text;
+    pack_screen_text(&text);
+    packed_font probe_packed(pack_fonts[pack_fonts_size - 1].packed);
+    probe_label.font(probe_font);
+    probe_label.text(text.data());
+    main_screen.update();
+    std::vector<uint8_t> frame(sim_fb.data(), sim_fb.data() + size);
+    probe_label.font(probe_packed);
+    main_screen.update();
+    const bool result = !memcmp(frame.data(), sim_fb.data(), size);
+    probe_label.font(probe_font_cache);
+    return result;
+}
+
+// frames to render per font
+static const size_t bench_packed_frames = 100;
+
+// draws the probe label text with fnt, returning the
+// mean frame time in microseconds
+static double bench_packed_run(font& fnt, const char* text) {
+    probe_label.font(fnt);
+    probe_label.text(text);
+    uint64_t total_us = 0;
+    for (size_t i = 0; i < bench_packed_frames; ++i) {
+        probe_label.invalidate();
+        uint32_t ts = micros();
+        main_screen.update();
+        total_us += micros() - ts;
+    }
+    return (double)total_us / bench_packed_frames;
+}
+int bench_packed() {
+    if (!pack_build()) {
+        return 1;
+    }
+    // the title image, decoded against rendering the SVG
+    std::vector<uint8_t> pixels(pack_title.pixels.size(), 0);
+    std::vector<uint8_t> svg;
+    uint32_t ts = micros();
+    pack_render_title(size16(pack_title.packed.width, pack_title.packed.height), &svg);
+    uint32_t svg_us = micros() - ts;
+    ts = micros();
+    packed_decode(pack_title.packed.data, 4, (size_t)pack_title.packed.width * pack_title.packed.height, pixels.data());
+    uint32_t decode_us = micros() - ts;
+    fprintf(stderr, "packed: title image, SVG %uus, decode %uus\n", (unsigned)svg_us, (unsigned)decode_us);
+    // then the whole screen, through the label
+    std::vector<char> text;
+    pack_screen_text(&text);
+    packed_font probe_packed(pack_fonts[pack_fonts_size - 1].packed);
+    double tt_us = bench_packed_run(probe_font, text.data());
+    double packed_us = bench_packed_run(probe_packed, text.data());
+    fprintf(stderr, "packed: probe screen, tt_font %0.0fus/frame, packed %0.0fus/frame, %0.1fx\n",
+            tt_us, packed_us, tt_us / packed_us);
+    probe_label.font(probe_font_cache);
+    return 0;
+}
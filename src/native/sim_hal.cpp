@@ -0,0 +1,338 @@
+#include <native/sim_hal.hpp>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <thread>
+
+sim_stream sim_monitor;
+sim_i2c_bus sim_i2c;
+sim_uart sim_ser;
+sim_framebuffer sim_fb;
+
+static const std::chrono::steady_clock::time_point sim_start = std::chrono::steady_clock::now();
+
+uint32_t millis() {
+    return (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now() - sim_start)
+        .count();
+}
+uint32_t micros() {
+    return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now() - sim_start)
+        .count();
+}
+void delay(uint32_t ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+sim_stream::sim_stream() : m_file(stdout),
+                           m_written(0),
+                           m_baud(0),
+                           m_tx_capacity(128),
+                           m_tx_pending(0),
+                           m_tx_ts(0) {
+}
+void sim_stream::drain() {
+    uint32_t now = micros();
+    if (m_baud == 0) {
+        m_tx_pending = 0;
+    } else {
+        // 8N1 puts 10 bits on the wire per byte
+        uint64_t sent = (uint64_t)(uint32_t)(now - m_tx_ts) * (m_baud / 10) / 1000000;
+        if (sent == 0) {
+            // don't advance the clock until a byte goes out
+            return;
+        }
+        m_tx_pending = sent >= m_tx_pending ? 0 : m_tx_pending - (size_t)sent;
+    }
+    m_tx_ts = now;
+}
+void sim_stream::begin(unsigned long baud) {
+    m_baud = baud;
+    m_tx_pending = 0;
+    m_tx_ts = micros();
+}
+void sim_stream::output(FILE* file) {
+    m_file = file;
+}
+int sim_stream::availableForWrite() {
+    drain();
+    return (int)(m_tx_capacity - m_tx_pending);
+}
+size_t sim_stream::write(const uint8_t* data, size_t size) {
+    drain();
+    if (m_tx_pending == 0) {
+        m_tx_ts = micros();
+    }
+    if (m_file != nullptr) {
+        size = fwrite(data, 1, size, m_file);
+    }
+    m_tx_pending += size;
+    m_written += size;
+    return size;
+}
+size_t sim_stream::written() const {
+    return m_written;
+}
+
+sim_i2c_bus::sim_i2c_bus() : m_start_ms(0),
+                             m_address(0),
+                             m_probe_us(100),
+                             m_began(false),
+                             m_probes(0),
+                             m_bus_us(0) {
+}
+const sim_i2c_bus::step* sim_i2c_bus::current() const {
+    const step* result = nullptr;
+    uint32_t ms = millis() - m_start_ms;
+    for (const step& s : m_script) {
+        if (s.ms > ms) {
+            break;
+        }
+        result = &s;
+    }
+    return result;
+}
+bool sim_i2c_bus::script(const char* path) {
+    FILE* file = fopen(path, "r");
+    if (file == nullptr) {
+        return false;
+    }
+    char line[512];
+    while (fgets(line, sizeof(line), file)) {
+        char* sz = line;
+        char* end;
+        unsigned long ms = strtoul(sz, &end, 0);
+        if (end == sz) {
+            // blank line or comment
+            continue;
+        }
+        uint32_t banks[4];
+        memset(banks, 0, sizeof(banks));
+        sz = end;
+        while (true) {
+            unsigned long addr = strtoul(sz, &end, 0);
+            if (end == sz) {
+                break;
+            }
+            sz = end;
+            if (addr < 128) {
+                banks[addr / 32] |= (1 << (addr % 32));
+            }
+        }
+        script_step((uint32_t)ms, banks);
+    }
+    fclose(file);
+    return true;
+}
+void sim_i2c_bus::script_step(uint32_t ms, const uint32_t* banks) {
+    step s;
+    s.ms = ms;
+    memcpy(s.banks, banks, sizeof(s.banks));
+    // keep the script sorted by time
+    auto it = m_script.begin();
+    while (it != m_script.end() && it->ms <= ms) {
+        ++it;
+    }
+    m_script.insert(it, s);
+}
+void sim_i2c_bus::rewind() {
+    m_start_ms = millis();
+}
+void sim_i2c_bus::probe_us(uint32_t value) {
+    m_probe_us = value;
+}
+bool sim_i2c_bus::begin(int sda, int scl) {
+    m_began = true;
+    return true;
+}
+void sim_i2c_bus::end() {
+    m_began = false;
+}
+void sim_i2c_bus::setTimeOut(uint16_t timeout_ms) {
+}
+void sim_i2c_bus::beginTransmission(uint8_t address) {
+    m_address = address;
+}
+uint8_t sim_i2c_bus::endTransmission(bool send_stop) {
+    if (!m_began) {
+        // not initialized
+        return 4;
+    }
+    ++m_probes;
+    m_bus_us += m_probe_us;
+    const step* s = current();
+    if (s != nullptr && m_address < 128 &&
+        (s->banks[m_address / 32] & (1 << (m_address % 32)))) {
+        return 0;
+    }
+    // NACK on address
+    return 2;
+}
+size_t sim_i2c_bus::probes() const {
+    return m_probes;
+}
+uint64_t sim_i2c_bus::bus_us() const {
+    return m_bus_us;
+}
+
+sim_uart::sim_uart() : m_file(nullptr),
+                       m_loop(false),
+                       m_bytes_per_sec(0),
+                       m_baud(115200),
+                       m_start_us(0),
+                       m_arrived(0),
+                       m_fifo(256),
+                       m_fifo_head(0),
+                       m_fifo_count(0),
+                       m_overflowed(0),
+                       m_received(0),
+                       m_eof(true) {
+}
+sim_uart::~sim_uart() {
+    if (m_file != nullptr) {
+        fclose(m_file);
+    }
+}
+bool sim_uart::open(const char* path, uint32_t bytes_per_sec, bool loop) {
+    std::lock_guard<std::mutex> guard(m_lock);
+    if (m_file != nullptr) {
+        fclose(m_file);
+    }
+    m_file = fopen(path, "rb");
+    if (m_file == nullptr) {
+        m_eof = true;
+        return false;
+    }
+    m_loop = loop;
+    m_bytes_per_sec = bytes_per_sec;
+    m_start_us = micros();
+    m_arrived = 0;
+    m_fifo_head = 0;
+    m_fifo_count = 0;
+    m_overflowed = 0;
+    m_received = 0;
+    m_eof = false;
+    return true;
+}
+void sim_uart::rx_buffer_size(size_t size) {
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_fifo.resize(size);
+    m_fifo_head = 0;
+    m_fifo_count = 0;
+}
+void sim_uart::begin(unsigned long baud, uint32_t config, int8_t rx_pin, int8_t tx_pin) {
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_baud = baud;
+}
+void sim_uart::updateBaudRate(unsigned long baud) {
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_baud = baud;
+}
+void sim_uart::pump() {
+    if (m_file == nullptr || m_eof) {
+        return;
+    }
+    // 8N1 puts 10 bits on the wire per byte
+    uint64_t rate = m_bytes_per_sec ? m_bytes_per_sec : m_baud / 10;
+    uint64_t due = (uint64_t)(uint32_t)(micros() - m_start_us) * rate / 1000000;
+    uint8_t buf[256];
+    while (m_arrived < due) {
+        size_t to_read = sizeof(buf);
+        if (due - m_arrived < to_read) {
+            to_read = (size_t)(due - m_arrived);
+        }
+        size_t got = fread(buf, 1, to_read, m_file);
+        if (got == 0) {
+            if (m_loop) {
+                fseek(m_file, 0, SEEK_SET);
+                continue;
+            }
+            m_eof = true;
+            break;
+        }
+        m_arrived += got;
+        m_received += got;
+        for (size_t i = 0; i < got; ++i) {
+            if (m_fifo_count == m_fifo.size()) {
+                ++m_overflowed;
+                continue;
+            }
+            m_fifo[(m_fifo_head + m_fifo_count) % m_fifo.size()] = buf[i];
+            ++m_fifo_count;
+        }
+    }
+}
+int sim_uart::available() {
+    std::lock_guard<std::mutex> guard(m_lock);
+    pump();
+    return (int)m_fifo_count;
+}
+size_t sim_uart::read(uint8_t* buffer, size_t size) {
+    std::lock_guard<std::mutex> guard(m_lock);
+    pump();
+    if (size > m_fifo_count) {
+        size = m_fifo_count;
+    }
+    for (size_t i = 0; i < size; ++i) {
+        buffer[i] = m_fifo[m_fifo_head];
+        m_fifo_head = (m_fifo_head + 1) % m_fifo.size();
+    }
+    m_fifo_count -= size;
+    return size;
+}
+bool sim_uart::eof() const {
+    std::lock_guard<std::mutex> guard(m_lock);
+    return m_eof && m_fifo_count == 0;
+}
+size_t sim_uart::overflowed() const {
+    std::lock_guard<std::mutex> guard(m_lock);
+    return m_overflowed;
+}
+size_t sim_uart::received() const {
+    std::lock_guard<std::mutex> guard(m_lock);
+    return m_received;
+}
+
+sim_framebuffer::sim_framebuffer() : m_width(0),
+                                     m_height(0),
+                                     m_pixel_bytes(0),
+                                     m_flushes(0),
+                                     m_bytes(0) {
+}
+void sim_framebuffer::initialize(uint16_t width, uint16_t height, size_t bit_depth) {
+    m_width = width;
+    m_height = height;
+    m_pixel_bytes = (bit_depth + 7) / 8;
+    m_data.assign((size_t)width * height * m_pixel_bytes, 0);
+    m_flushes = 0;
+    m_bytes = 0;
+}
+void sim_framebuffer::draw_bitmap(int x1, int y1, int x2, int y2, const void* bitmap) {
+    ++m_flushes;
+    const size_t src_stride = (x2 - x1 + 1) * m_pixel_bytes;
+    m_bytes += src_stride * (y2 - y1 + 1);
+    const uint8_t* src = (const uint8_t*)bitmap;
+    for (int y = y1; y <= y2; ++y) {
+        if (y >= 0 && y < m_height) {
+            int cx1 = x1 < 0 ? 0 : x1;
+            int cx2 = x2 >= m_width ? m_width - 1 : x2;
+            if (cx1 <= cx2) {
+                memcpy(&m_data[((size_t)y * m_width + cx1) * m_pixel_bytes],
+                       src + (cx1 - x1) * m_pixel_bytes,
+                       (cx2 - cx1 + 1) * m_pixel_bytes);
+            }
+        }
+        src += src_stride;
+    }
+}
+const uint8_t* sim_framebuffer::data() const {
+    return m_data.data();
+}
+size_t sim_framebuffer::flushes() const {
+    return m_flushes;
+}
+uint64_t sim_framebuffer::bytes() const {
+    return m_bytes;
+}
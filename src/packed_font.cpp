@@ -0,0 +1,185 @@
+#include <packed_font.hpp>
+#include <string.h>
+using namespace gfx;
+
+size_t packed_decode(const uint8_t* data, size_t unit, size_t count, void* out) {
+    const uint8_t* p = data;
+    uint8_t* pout = (uint8_t*)out;
+    while (count) {
+        uint8_t header = *p++;
+        if (header < 128) {
+            size_t run = header + 1;
+            memcpy(pout, p, run * unit);
+            p += run * unit;
+            pout += run * unit;
+            count -= run;
+        } else {
+            size_t run = header - 126;
+            if (unit == 1) {
+                memset(pout, *p, run);
+                pout += run;
+            } else {
+                for (size_t i = 0; i < run; ++i) {
+                    memcpy(pout, p, unit);
+                    pout += unit;
+                }
+            }
+            p += unit;
+            count -= run;
+        }
+    }
+    return p - data;
+}
+// true if the min units starting at i are all the same
+static bool packed_repeats(const uint8_t* p, size_t unit, size_t count, size_t i, size_t min) {
+    if (i + min > count) {
+        return false;
+    }
+    for (size_t j = 1; j < min; ++j) {
+        if (memcmp(p + i * unit, p + (i + j) * unit, unit)) {
+            return false;
+        }
+    }
+    return true;
+}
+size_t packed_encode(const void* data, size_t unit, size_t count, uint8_t* out) {
+    const uint8_t* p = (const uint8_t*)data;
+    uint8_t* pout = out;
+    // a short byte run costs as much as its literals
+    // and splits the literal run it sits in
+    const size_t min_run = unit == 1 ? 3 : 2;
+    size_t i = 0;
+    while (i < count) {
+        if (packed_repeats(p, unit, count, i, min_run)) {
+            size_t run = min_run;
+            while (i + run < count && run < 129 &&
+                   !memcmp(p + i * unit, p + (i + run) * unit, unit)) {
+                ++run;
+            }
+            *pout++ = (uint8_t)(run + 126);
+            memcpy(pout, p + i * unit, unit);
+            pout += unit;
+            i += run;
+            continue;
+        }
+        // gather literals up to the next repeat
+        size_t start = i++;
+        while (i < count && i - start < 128 &&
+               !packed_repeats(p, unit, count, i, min_run)) {
+            ++i;
+        }
+        *pout++ = (uint8_t)(i - start - 1);
+        memcpy(pout, p + start * unit, (i - start) * unit);
+        pout += (i - start) * unit;
+    }
+    return pout - out;
+}
+
+packed_font::packed_font() : m_data(nullptr) {
+}
+packed_font::packed_font(const packed_font_data_t& data) : m_data(&data) {
+}
+void packed_font::data(const packed_font_data_t& data) {
+    m_data = &data;
+}
+gfx_result packed_font::initialize() {
+    return m_data != nullptr ? gfx_result::success : gfx_result::invalid_state;
+}
+bool packed_font::initialized() const {
+    return m_data != nullptr;
+}
+void packed_font::deinitialize() {
+}
+uint16_t packed_font::line_height() const {
+    return m_data->line_height;
+}
+uint16_t packed_font::line_advance() const {
+    return m_data->line_advance;
+}
+uint16_t packed_font::base_line() const {
+    return m_data->base_line;
+}
+int packed_font::find(int32_t codepoint) const {
+    int lo = 0;
+    int hi = (int)m_data->glyph_count - 1;
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        int32_t cp = m_data->glyphs[mid].codepoint;
+        if (cp == codepoint) {
+            return mid;
+        }
+        if (cp < codepoint) {
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    return -1;
+}
+gfx_result packed_font::on_measure(int32_t codepoint1,
+                                   int32_t codepoint2,
+                                   font_glyph_info* out_glyph_info) const {
+    int i = find(codepoint1);
+    if (i == -1) {
+        // not in the subset
+        return gfx_result::invalid_argument;
+    }
+    const packed_glyph_t& g = m_data->glyphs[i];
+    int16_t advance = g.advance;
+    if (m_data->kern_count) {
+        int lo = 0;
+        int hi = (int)m_data->kern_count - 1;
+        while (lo <= hi) {
+            int mid = (lo + hi) / 2;
+            const packed_kern_t& k = m_data->kerns[mid];
+            if (k.codepoint1 == codepoint1 && k.codepoint2 == codepoint2) {
+                advance += k.adjust;
+                break;
+            }
+            if (k.codepoint1 < codepoint1 ||
+                (k.codepoint1 == codepoint1 && k.codepoint2 < codepoint2)) {
+                lo = mid + 1;
+            } else {
+                hi = mid - 1;
+            }
+        }
+    }
+    out_glyph_info->glyph_index1 = i;
+    out_glyph_info->glyph_index2 = find(codepoint2);
+    out_glyph_info->dimensions = size16(g.width, g.height);
+    out_glyph_info->offset = spoint16(g.offset_x, g.offset_y);
+    out_glyph_info->advance_width = advance;
+    return gfx_result::success;
+}
+gfx_result packed_font::on_draw(bitmap<alpha_pixel<8>>& destination,
+                                int32_t codepoint,
+                                int32_t glyph_index) const {
+    if (glyph_index < 0 || glyph_index >= (int32_t)m_data->glyph_count) {
+        glyph_index = find(codepoint);
+        if (glyph_index == -1) {
+            return gfx_result::invalid_argument;
+        }
+    }
+    const packed_glyph_t& g = m_data->glyphs[glyph_index];
+    const size16 dim = destination.dimensions();
+    if (dim.width == g.width && dim.height == g.height) {
+        packed_decode(m_data->data + g.data, 1, (size_t)g.width * g.height, destination.begin());
+        return gfx_result::success;
+    }
+    // a differently sized destination. Decode
+    // a row at a time and crop
+    const uint8_t* p = m_data->data + g.data;
+    uint8_t row[256];
+    if (g.width > sizeof(row)) {
+        return gfx_result::not_supported;
+    }
+    memset(destination.begin(), 0, (size_t)dim.width * dim.height);
+    size_t w = g.width < dim.width ? g.width : dim.width;
+    for (int y = 0; y < g.height; ++y) {
+        p += packed_decode(p, 1, g.width, row);
+        if (y < dim.height) {
+            memcpy(destination.begin() + (size_t)y * dim.width, row, w);
+        }
+    }
+    return gfx_result::success;
+}
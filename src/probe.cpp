@@ -0,0 +1,430 @@
+#include <ctype.h>
+#include <hal.hpp>
+#include <hex_dump.hpp>
+#include <i2c_session.hpp>
+#include <monitor_out.hpp>
+#include <probe.hpp>
+#include <serial_capture.hpp>
+#include <serial_formatter.hpp>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ui.hpp>
+#ifdef ARDUINO
+#include "driver/i2c.h"
+#endif
+
+// serial data
+const int serial_bauds[] = {
+    115200,
+    19200,
+    9600,
+    2400,
+    921600};
+const size_t serial_bauds_size = sizeof(serial_bauds) / sizeof(int);
+std::atomic<size_t> serial_baud_index(0);
+std::atomic_bool serial_bin(false);
+bool is_serial = false;
+// the formatted serial display
+serial_formatter serial_view;
+// the monitor column for binary output
+static int serial_mon_cols = 0;
+// the capture losses last reported
+static size_t serial_lost = 0;
+// serial bytes taken from the capture buffer
+size_t serial_received = 0;
+
+// probe display data
+char* display_text = nullptr;
+size_t display_text_capacity = 0;
+
+// i2c address data
+static uint32_t i2c_addresses_old[4];
+// the formatted address list, held until shown
+static char* i2c_text = nullptr;
+
+// the i2c sweep's bus clock and per address timeouts.
+// Devices answer an address within a clock or two, so the
+// first pass gives up quickly. Addresses that timed out
+// rather than NACKed are probed again with the long timeout,
+// unless so many timed out that the bus must be stuck
+#ifndef I2C_SCAN_FREQ
+#define I2C_SCAN_FREQ 400000
+#endif
+#ifndef I2C_SCAN_TIMEOUT_US
+#define I2C_SCAN_TIMEOUT_US 500
+#endif
+#ifndef I2C_SCAN_RETRY_TIMEOUT_US
+#define I2C_SCAN_RETRY_TIMEOUT_US 10000
+#endif
+#ifndef I2C_SCAN_RETRY_MAX
+#define I2C_SCAN_RETRY_MAX 8
+#endif
+
+// the scanner's bus, installed once and kept
+i2c_session probe_i2c_session;
+
+// serial monitor echo
+#define MONITOR_BUFFER_SIZE 4096
+#define MONITOR_WATERMARK (MONITOR_BUFFER_SIZE / 2)
+monitor_out probe_monitor;
+
+bool probe_init() {
+    // clear the i2c data
+    memset(&i2c_addresses_old, 0, sizeof(i2c_addresses_old));
+    // compute the amount of string we need to fill the display
+    display_text_capacity = probe_cols * (probe_rows + 1) + 1;
+    // and allocate it (shouldn't be much)
+    display_text = (char*)malloc(display_text_capacity);
+    if (display_text == nullptr) {
+        puts("Could not allocate display text");
+        return false;
+    }
+    *display_text = '\0';
+    i2c_text = (char*)malloc(display_text_capacity);
+    if (i2c_text == nullptr) {
+        puts("Could not allocate i2c text");
+        return false;
+    }
+    *i2c_text = '\0';
+    if (!serial_view.initialize(probe_cols, probe_rows)) {
+        puts("Could not allocate serial display");
+        return false;
+    }
+    if (!probe_monitor.initialize(MONITOR_BUFFER_SIZE, MONITOR_WATERMARK)) {
+        puts("Could not allocate monitor buffer");
+        return false;
+    }
+    return true;
+}
+#ifdef ARDUINO
+// sets how long a device may hold the clock low
+static void probe_i2c_timeout(uint32_t us) {
+#ifdef CONFIG_IDF_TARGET_ESP32
+    // in APB cycles, up to ~13ms
+    uint32_t cycles = us * (APB_CLK_FREQ / 1000000);
+    i2c_set_timeout(I2C_NUM_0, cycles < 0xFFFFF ? (int)cycles : 0xFFFFF);
+#endif
+}
+// probes an address with an empty write: a start, the
+// address and a stop. ESP_OK is an ACK, ESP_FAIL a NACK and
+// ESP_ERR_TIMEOUT a device holding the clock or a stuck bus
+static esp_err_t probe_i2c_address(uint8_t address, uint32_t timeout_us) {
+    // room for one transaction, so probing
+    // doesn't touch the heap
+    uint8_t buffer[I2C_LINK_RECOMMENDED_SIZE(1)];
+    i2c_cmd_handle_t cmd = i2c_cmd_link_create_static(buffer, sizeof(buffer));
+    i2c_master_start(cmd);
+    i2c_master_write_byte(cmd, (address << 1) | I2C_MASTER_WRITE, true);
+    i2c_master_stop(cmd);
+    esp_err_t result = i2c_master_cmd_begin(I2C_NUM_0, cmd, pdMS_TO_TICKS(timeout_us / 1000) + 1);
+    i2c_cmd_link_delete_static(cmd);
+    return result;
+}
+#endif
+bool probe_scan_i2c(uint32_t* banks, probe_i2c_found_callback found, void* state) {
+#ifdef ARDUINO
+    memset(banks, 0, sizeof(uint32_t) * 4);
+    probe_i2c_session.settings(I2C_SDA, I2C_SCL, I2C_SCAN_FREQ);
+    if (!probe_i2c_session.open()) {
+        return false;
+    }
+    // addresses that didn't answer in time
+    uint32_t slow[4] = {0, 0, 0, 0};
+    int slow_count = 0;
+    probe_i2c_timeout(I2C_SCAN_TIMEOUT_US);
+    for (uint8_t i = 0; i < 127; i++) {
+        esp_err_t result = probe_i2c_address(i, I2C_SCAN_TIMEOUT_US);
+        if (result == ESP_OK) {
+            banks[i / 32] |= (1 << (i % 32));
+            if (found != nullptr) {
+                found(i, state);
+            }
+        } else if (result == ESP_ERR_TIMEOUT) {
+            slow[i / 32] |= (1 << (i % 32));
+            ++slow_count;
+        } else if (result != ESP_FAIL) {
+            // the driver is in a bad state
+            probe_i2c_session.error();
+            return false;
+        }
+    }
+    if (slow_count > I2C_SCAN_RETRY_MAX) {
+        // the bus is stuck. Start over next time
+        probe_i2c_session.error();
+        return false;
+    }
+    if (slow_count) {
+        probe_i2c_timeout(I2C_SCAN_RETRY_TIMEOUT_US);
+        for (uint8_t i = 0; i < 127; i++) {
+            if (slow[i / 32] & (1 << (i % 32))) {
+                esp_err_t result = probe_i2c_address(i, I2C_SCAN_RETRY_TIMEOUT_US);
+                if (result == ESP_OK) {
+                    banks[i / 32] |= (1 << (i % 32));
+                    if (found != nullptr) {
+                        found(i, state);
+                    }
+                } else if (result != ESP_FAIL) {
+                    // still no answer, so it's not known
+                    // whether anything is there
+                    probe_i2c_session.error();
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+#else
+    return probe_scan_i2c_wire(banks, found, state);
+#endif
+}
+bool probe_scan_i2c_wire(uint32_t* banks, probe_i2c_found_callback found, void* state) {
+    // clear the banks
+    memset(banks, 0, sizeof(uint32_t) * 4);
+    // Wire's default clock
+    probe_i2c_session.settings(I2C_SDA, I2C_SCL, 100000);
+    if (!probe_i2c_session.open()) {
+        return false;
+    }
+    // catch slow devices
+    I2C.setTimeOut(uint16_t(-1));
+    // for every address
+    for (uint8_t i = 0; i < 127; i++) {
+        // start a transmission, and see
+        // if it's successful
+        I2C.beginTransmission(i);
+        uint8_t result = I2C.endTransmission();
+        if (result == 0) {
+            // if so, set the corresponding bit
+            banks[i / 32] |= (1 << (i % 32));
+            if (found != nullptr) {
+                found(i, state);
+            }
+        } else if (result > 3) {
+            // not a NACK but a bus or driver error
+            probe_i2c_session.error();
+            return false;
+        }
+    }
+    return true;
+}
+bool probe_poll_i2c(const uint32_t* addresses, uint32_t* banks) {
+#ifdef ARDUINO
+    probe_i2c_session.settings(I2C_SDA, I2C_SCL, I2C_SCAN_FREQ);
+#endif
+    if (!probe_i2c_session.open()) {
+        return false;
+    }
+#ifdef ARDUINO
+    // there are only a few, so give slow
+    // devices the long timeout up front
+    probe_i2c_timeout(I2C_SCAN_RETRY_TIMEOUT_US);
+#endif
+    // only an ACK or a NACK says whether a device is
+    // there, so nothing is kept unless they all got one
+    uint32_t polled[4];
+    memcpy(polled, banks, sizeof(polled));
+    for (uint8_t i = 0; i < 127; i++) {
+        const uint32_t mask = 1 << (i % 32);
+        if (!(addresses[i / 32] & mask)) {
+            continue;
+        }
+#ifdef ARDUINO
+        esp_err_t result = probe_i2c_address(i, I2C_SCAN_RETRY_TIMEOUT_US);
+        if (result == ESP_OK) {
+            polled[i / 32] |= mask;
+        } else if (result == ESP_FAIL) {
+            polled[i / 32] &= ~mask;
+        } else {
+            probe_i2c_session.error();
+            return false;
+        }
+#else
+        I2C.beginTransmission(i);
+        uint8_t result = I2C.endTransmission();
+        if (result == 0) {
+            polled[i / 32] |= mask;
+        } else if (result <= 3) {
+            polled[i / 32] &= ~mask;
+        } else {
+            probe_i2c_session.error();
+            return false;
+        }
+#endif
+    }
+    memcpy(banks, polled, sizeof(polled));
+    return true;
+}
+// formats the address list from the given row on, keeping
+// the rows before it. first is the lowest address the row
+// could hold
+static void probe_format_i2c(int row, int first) {
+    // find the end of the rows that stay
+    size_t len = 0;
+    for (int r = 0; r < row; ++r) {
+        if (r) {
+            // the newline ending the row before
+            ++len;
+        }
+        while (i2c_text[len] && i2c_text[len] != '\n') {
+            ++len;
+        }
+    }
+    i2c_text[len] = '\0';
+    int count = row;
+    for (int i = first; i < 128 && count < probe_rows - 1; ++i) {
+        // if its bit is set
+        if (i2c_addresses_old[i / 32] & (1 << (i % 32))) {
+            // insert newlines at the end of the
+            // previous row, if there was one
+            if (count) {
+                i2c_text[len++] = '\n';
+            }
+            ++count;
+            // display an address
+            len += snprintf(i2c_text + len, display_text_capacity - len, "0x%02X:%d", i, i);
+        }
+    }
+    if (!count) {
+        // display none if there weren't any
+        memcpy(i2c_text, "<none>\0", 7);
+    }
+}
+bool probe_refresh_i2c(const uint32_t* banks) {
+    // if our addresses have changed
+    if (memcmp(banks, i2c_addresses_old, sizeof(i2c_addresses_old))) {
+        // set the old addresses to the latest
+        memcpy(i2c_addresses_old, banks, sizeof(i2c_addresses_old));
+        probe_format_i2c(0, 0);
+        probe_echo_i2c();
+        // return true, indicating a change
+        return true;
+    }
+    // no change
+    return false;
+}
+bool probe_apply_i2c(uint8_t address, bool present) {
+    if (address >= 128) {
+        return false;
+    }
+    uint32_t& bank = i2c_addresses_old[address / 32];
+    const uint32_t mask = 1 << (address % 32);
+    if (((bank & mask) != 0) == present) {
+        return false;
+    }
+    if (present) {
+        bank |= mask;
+    } else {
+        bank &= ~mask;
+    }
+    // its row is the number of addresses below it. Rows
+    // above it stay as they are, and so do all of them
+    // if it's past the last row shown
+    int row = 0;
+    for (int i = 0; i < address; ++i) {
+        if (i2c_addresses_old[i / 32] & (1 << (i % 32))) {
+            ++row;
+        }
+    }
+    if (row < probe_rows - 1) {
+        probe_format_i2c(row, address);
+    }
+    return true;
+}
+void probe_echo_i2c() {
+    int count = 0;
+    for (int i = 0; i < 128; ++i) {
+        if (i2c_addresses_old[i / 32] & (1 << (i % 32))) {
+            probe_monitor.printf("0x%02X:%d\n", i, i);
+            ++count;
+        }
+    }
+    if (!count) {
+        probe_monitor.print("<none>\n");
+    }
+    probe_monitor.print('\n');
+    probe_monitor.flush();
+}
+bool probe_refresh_serial() {
+    ring_buffer<uint8_t>& serial_data = serial_capture_buffer();
+    // if we have incoming data
+    if (!serial_data.empty()) {
+        // the mode can change under us
+        const bool bin = serial_bin;
+        serial_view.binary(bin);
+        // format and echo only what just arrived
+        const uint8_t* spans[2];
+        size_t span_sizes[2];
+        size_t size = serial_data.peek(&spans[0], &span_sizes[0], &spans[1], &span_sizes[1]);
+        for (int s = 0; s < 2; ++s) {
+            serial_view.write(spans[s], span_sizes[s]);
+            const uint8_t* pb = spans[s];
+            size_t pbc = span_sizes[s];
+            if (!bin) {  // text
+                char buf[64];
+                while (pbc) {
+                    size_t run = pbc < sizeof(buf) ? pbc : sizeof(buf);
+                    for (size_t i = 0; i < run; ++i) {
+                        uint8_t b = pb[i];
+                        // monitor follows slightly different
+                        // rules than the display
+                        if (b == ' ' || isprint(b) ||
+                            b == '\n' || b == '\r' || b == '\t') {
+                            buf[i] = (char)b;
+                        } else {
+                            buf[i] = '.';
+                        }
+                    }
+                    probe_monitor.write(buf, run);
+                    pb += run;
+                    pbc -= run;
+                }
+            } else {  // binary
+                // dump to the monitor 10 bytes to a line
+                char buf[10 * 3 + 1];
+                while (pbc) {
+                    size_t run = 10 - serial_mon_cols;
+                    if (run > pbc) {
+                        run = pbc;
+                    }
+                    size_t len = hex_dump(pb, run, buf);
+                    pb += run;
+                    pbc -= run;
+                    serial_mon_cols += (int)run;
+                    if (serial_mon_cols == 10) {
+                        buf[len++] = '\n';
+                        serial_mon_cols = 0;
+                    }
+                    probe_monitor.write(buf, len);
+                }
+            }
+        }
+        serial_data.consume(size);
+        serial_received += size;
+        // report anything capture lost
+        serial_capture_stats_t stats;
+        serial_capture_statistics(&stats);
+        size_t lost = stats.overflowed + stats.dropped;
+        if (lost != serial_lost) {
+            probe_monitor.printf("\n[serial: %u bytes lost]\n", (unsigned)(lost - serial_lost));
+            serial_lost = lost;
+        }
+        // send the echo in one go
+        probe_monitor.flush();
+        // report a change
+        return true;
+    }
+    // no change
+    return false;
+}
+void probe_show_i2c() {
+    memcpy(display_text, i2c_text, display_text_capacity);
+    // serial starts over the next time it's shown
+    serial_view.clear();
+    is_serial = false;
+}
+void probe_show_serial() {
+    serial_view.text(display_text, display_text_capacity);
+    serial_view.clean();
+    is_serial = true;
+}
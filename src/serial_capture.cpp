@@ -0,0 +1,214 @@
+#include <hal.hpp>
+#include <serial_capture.hpp>
+#include <string.h>
+
+#include <atomic>
+#ifdef ARDUINO
+#include <driver/uart.h>
+#include <thread.hpp>
+using namespace freertos;
+#else
+#include <thread>
+#endif
+
+static ring_buffer<uint8_t> serial_capture_data;
+static std::atomic<bool> serial_capture_running(false);
+static std::atomic<bool> serial_capture_stopped(true);
+static std::atomic<size_t> serial_capture_received(0);
+static std::atomic<size_t> serial_capture_overflows(0);
+static std::atomic<size_t> serial_capture_overflowed(0);
+static std::atomic<size_t> serial_capture_dropped(0);
+static std::atomic<uint32_t> serial_capture_busy_us(0);
+
+#ifdef ARDUINO
+// the UART driver's receive buffer
+#define SERIAL_CAPTURE_RX_BUFFER_SIZE 2048
+// wake the task when the 128 byte FIFO is half full
+// so there's ~0.7ms of headroom even at 921600
+#define SERIAL_CAPTURE_RX_FULL_THRESHOLD 64
+// or when the line has been idle for this many symbols
+#define SERIAL_CAPTURE_RX_TIMEOUT 2
+
+static QueueHandle_t serial_capture_queue = nullptr;
+static thread serial_capture_thread;
+
+// reads up to size bytes from the driver into the
+// capture buffer, dropping what doesn't fit
+static void serial_capture_drain(size_t size) {
+    while (size) {
+        size_t span;
+        uint8_t* p = serial_capture_data.write_span(&span);
+        uint8_t scratch[64];
+        bool dropping = span == 0;
+        if (dropping) {
+            // the consumer is behind. Read it anyway
+            // so the driver doesn't overflow too
+            p = scratch;
+            span = sizeof(scratch);
+        }
+        if (span > size) {
+            span = size;
+        }
+        int read = uart_read_bytes(SER_UART, p, span, 0);
+        if (read <= 0) {
+            break;
+        }
+        if (dropping) {
+            serial_capture_dropped += read;
+        } else {
+            serial_capture_data.commit(read);
+            serial_capture_received += read;
+        }
+        size -= read;
+    }
+}
+// waits on the UART driver's events and drains the data
+static void serial_capture_task(void* state) {
+    uart_event_t event;
+    while (serial_capture_running) {
+        if (!xQueueReceive(serial_capture_queue, &event, pdMS_TO_TICKS(100))) {
+            continue;
+        }
+        const uint32_t ts = micros();
+        switch (event.type) {
+            case UART_DATA:
+                serial_capture_drain(event.size);
+                break;
+            case UART_FIFO_OVF:
+                // the driver resets the FIFO, losing
+                // at most what it held
+                serial_capture_overflowed += UART_FIFO_LEN;
+                // fall through
+            case UART_BUFFER_FULL: {
+                // drain everything that made it
+                // so reception resumes
+                ++serial_capture_overflows;
+                size_t buffered = 0;
+                uart_get_buffered_data_len(SER_UART, &buffered);
+                serial_capture_drain(buffered);
+            } break;
+            default:
+                break;
+        }
+        serial_capture_busy_us += micros() - ts;
+    }
+    serial_capture_stopped = true;
+}
+bool serial_capture_begin(int baud, size_t capacity) {
+    if (!serial_capture_data.initialize(capacity)) {
+        return false;
+    }
+    uart_config_t config;
+    memset(&config, 0, sizeof(config));
+    config.baud_rate = baud;
+    config.data_bits = UART_DATA_8_BITS;
+    config.parity = UART_PARITY_DISABLE;
+    config.stop_bits = UART_STOP_BITS_1;
+    config.flow_ctrl = UART_HW_FLOWCTRL_DISABLE;
+    config.source_clk = UART_SCLK_APB;
+    if (ESP_OK != uart_driver_install(SER_UART,
+                                      SERIAL_CAPTURE_RX_BUFFER_SIZE,
+                                      0,
+                                      20,
+                                      &serial_capture_queue,
+                                      0)) {
+        return false;
+    }
+    uart_param_config(SER_UART, &config);
+    uart_set_pin(SER_UART, UART_PIN_NO_CHANGE, SER_RX, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE);
+    uart_set_rx_full_threshold(SER_UART, SERIAL_CAPTURE_RX_FULL_THRESHOLD);
+    uart_set_rx_timeout(SER_UART, SERIAL_CAPTURE_RX_TIMEOUT);
+    serial_capture_running = true;
+    serial_capture_stopped = false;
+    // higher priority than everything else on
+    // its core so nothing delays the drain
+    serial_capture_thread = thread::create_affinity(CAPTURE_CORE,
+                                                    serial_capture_task,
+                                                    nullptr,
+                                                    20,
+                                                    2048);
+    if (serial_capture_thread.handle() == nullptr) {
+        serial_capture_running = false;
+        serial_capture_stopped = true;
+        uart_driver_delete(SER_UART);
+        return false;
+    }
+    serial_capture_thread.start();
+    return true;
+}
+void serial_capture_end() {
+    serial_capture_running = false;
+    while (!serial_capture_stopped) {
+        delay(1);
+    }
+    uart_driver_delete(SER_UART);
+    serial_capture_queue = nullptr;
+}
+void serial_capture_baud(int baud) {
+    uart_set_baudrate(SER_UART, baud);
+}
+#else
+// the host has no UART interrupts so a
+// thread polls the simulated one instead
+static std::thread serial_capture_thread;
+static void serial_capture_task() {
+    while (serial_capture_running) {
+        const uint32_t ts = micros();
+        size_t available = (size_t)SER.available();
+        while (available) {
+            size_t span;
+            uint8_t* p = serial_capture_data.write_span(&span);
+            if (span == 0) {
+                uint8_t scratch[64];
+                size_t read = SER.read(scratch, available < sizeof(scratch) ? available : sizeof(scratch));
+                serial_capture_dropped += read;
+                available -= read;
+                continue;
+            }
+            if (span > available) {
+                span = available;
+            }
+            size_t read = SER.read(p, span);
+            if (read == 0) {
+                break;
+            }
+            serial_capture_data.commit(read);
+            serial_capture_received += read;
+            available -= read;
+        }
+        serial_capture_overflowed = sim_ser.overflowed();
+        serial_capture_busy_us += micros() - ts;
+        delay(1);
+    }
+    serial_capture_stopped = true;
+}
+bool serial_capture_begin(int baud, size_t capacity) {
+    if (!serial_capture_data.initialize(capacity)) {
+        return false;
+    }
+    SER.begin(baud, SERIAL_8N1, SER_RX, -1);
+    serial_capture_running = true;
+    serial_capture_stopped = false;
+    serial_capture_thread = std::thread(serial_capture_task);
+    return true;
+}
+void serial_capture_end() {
+    serial_capture_running = false;
+    if (serial_capture_thread.joinable()) {
+        serial_capture_thread.join();
+    }
+}
+void serial_capture_baud(int baud) {
+    SER.updateBaudRate(baud);
+}
+#endif
+ring_buffer<uint8_t>& serial_capture_buffer() {
+    return serial_capture_data;
+}
+void serial_capture_statistics(serial_capture_stats_t* out_stats) {
+    out_stats->received = serial_capture_received;
+    out_stats->overflows = serial_capture_overflows;
+    out_stats->overflowed = serial_capture_overflowed;
+    out_stats->dropped = serial_capture_dropped;
+    out_stats->busy_us = serial_capture_busy_us;
+}
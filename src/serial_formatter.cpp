@@ -0,0 +1,204 @@
+#include <ctype.h>
+#include <hex_dump.hpp>
+#include <serial_formatter.hpp>
+#include <stdlib.h>
+#include <string.h>
+
+serial_formatter::serial_formatter() : m_data(nullptr),
+                                       m_lengths(nullptr),
+                                       m_cols(0),
+                                       m_rows(0),
+                                       m_top(0),
+                                       m_count(0),
+                                       m_cursor(0),
+                                       m_binary(false),
+                                       m_dirty_first(-1),
+                                       m_dirty_last(-1),
+                                       m_scrolled(0) {
+}
+serial_formatter::~serial_formatter() {
+    deinitialize();
+}
+bool serial_formatter::initialize(uint16_t cols, uint16_t rows) {
+    deinitialize();
+    if (cols < 3 || rows == 0) {
+        return false;
+    }
+    m_data = (char*)malloc((size_t)cols * rows);
+    if (m_data == nullptr) {
+        return false;
+    }
+    m_lengths = (uint16_t*)malloc(rows * sizeof(uint16_t));
+    if (m_lengths == nullptr) {
+        free(m_data);
+        m_data = nullptr;
+        return false;
+    }
+    m_cols = cols;
+    m_rows = rows;
+    clear();
+    return true;
+}
+void serial_formatter::deinitialize() {
+    if (m_data != nullptr) {
+        free(m_data);
+        m_data = nullptr;
+    }
+    if (m_lengths != nullptr) {
+        free(m_lengths);
+        m_lengths = nullptr;
+    }
+    m_cols = 0;
+    m_rows = 0;
+}
+uint16_t serial_formatter::cols() const {
+    return m_cols;
+}
+uint16_t serial_formatter::rows() const {
+    return m_rows;
+}
+bool serial_formatter::binary() const {
+    return m_binary;
+}
+void serial_formatter::binary(bool value) {
+    if (value != m_binary) {
+        m_binary = value;
+        clear();
+    }
+}
+uint16_t serial_formatter::cells() const {
+    // binary is "XX XX XX" - the last byte
+    // on a row has no trailing space
+    return m_binary ? (m_cols + 1) / 3 : m_cols;
+}
+void serial_formatter::dirty(int row) {
+    if (m_dirty_first == -1 || row < m_dirty_first) {
+        m_dirty_first = row;
+    }
+    if (row > m_dirty_last) {
+        m_dirty_last = row;
+    }
+}
+void serial_formatter::clear() {
+    m_top = 0;
+    m_count = 0;
+    m_cursor = 0;
+    if (m_lengths != nullptr) {
+        memset(m_lengths, 0, m_rows * sizeof(uint16_t));
+    }
+    // everything changed
+    m_dirty_first = 0;
+    m_dirty_last = m_rows - 1;
+}
+void serial_formatter::new_row() {
+    if (m_count < m_rows) {
+        ++m_count;
+    } else {
+        // drop the top row. Every row
+        // moves up on the display
+        if (++m_top == m_rows) {
+            m_top = 0;
+        }
+        ++m_scrolled;
+        dirty(0);
+    }
+    m_lengths[(m_top + m_count - 1) % m_rows] = 0;
+    m_cursor = 0;
+    dirty(m_count - 1);
+}
+void serial_formatter::write(const uint8_t* data, size_t size) {
+    if (m_data == nullptr || size == 0) {
+        return;
+    }
+    const uint16_t row_cells = cells();
+    if (m_count == 0) {
+        new_row();
+    }
+    uint16_t phys = (m_top + m_count - 1) % m_rows;
+    char* row = m_data + (size_t)phys * m_cols;
+    uint16_t len = m_lengths[phys];
+    dirty(m_count - 1);
+    while (size) {
+        if (m_cursor == row_cells) {
+            m_lengths[phys] = len;
+            new_row();
+            phys = (m_top + m_count - 1) % m_rows;
+            row = m_data + (size_t)phys * m_cols;
+            len = 0;
+        }
+        if (m_binary) {
+            // format as much of the row as we can at once
+            size_t run = row_cells - m_cursor;
+            if (run > size) {
+                run = size;
+            }
+            if (m_cursor) {
+                row[len++] = ' ';
+            }
+            len += (uint16_t)hex_dump_row(data, run, row + len);
+            data += run;
+            size -= run;
+            m_cursor += (uint16_t)run;
+        } else {
+            uint8_t b = *data++;
+            --size;
+            // if it's printable, print it
+            // otherwise, print '.'
+            row[len++] = (b == ' ' || isprint(b)) ? (char)b : '.';
+            ++m_cursor;
+        }
+    }
+    m_lengths[phys] = len;
+}
+uint16_t serial_formatter::count() const {
+    return m_count;
+}
+const char* serial_formatter::row(uint16_t index, uint16_t* out_length) const {
+    if (index >= m_count) {
+        *out_length = 0;
+        return nullptr;
+    }
+    uint16_t phys = (m_top + index) % m_rows;
+    *out_length = m_lengths[phys];
+    return m_data + (size_t)phys * m_cols;
+}
+bool serial_formatter::dirty(uint16_t* out_first, uint16_t* out_last) const {
+    if (m_dirty_first == -1) {
+        return false;
+    }
+    *out_first = (uint16_t)m_dirty_first;
+    *out_last = (uint16_t)m_dirty_last;
+    return true;
+}
+size_t serial_formatter::scrolled() const {
+    return m_scrolled;
+}
+void serial_formatter::clean() {
+    m_dirty_first = -1;
+    m_dirty_last = -1;
+    m_scrolled = 0;
+}
+size_t serial_formatter::text(char* out_text, size_t capacity) const {
+    if (capacity == 0) {
+        return 0;
+    }
+    char* sz = out_text;
+    char* end = out_text + capacity - 1;
+    for (uint16_t i = 0; i < m_count; ++i) {
+        uint16_t len;
+        const char* p = row(i, &len);
+        if (i) {
+            if (sz == end) {
+                break;
+            }
+            *sz++ = '\n';
+        }
+        if (len > end - sz) {
+            len = (uint16_t)(end - sz);
+        }
+        memcpy(sz, p, len);
+        sz += len;
+    }
+    *sz = '\0';
+    return sz - out_text;
+}
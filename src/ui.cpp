@@ -1,18 +1,29 @@
 #include <lcd_config.h>
 #include <ui.hpp>
 #include <uix.hpp>
+#ifdef PACKED_ASSETS
+#define PACKED_ASSETS_IMPLEMENTATION
+#include <assets/packed_assets.h>
+packed_font title_font(title_packed_font);
+packed_font probe_font(probe_packed_font);
+packed_font probe_msg_font(probe_msg_packed_font);
+#else
 #define PROBE_IMPLEMENTATION
 #include <assets/probe.h>
 #define OPENSANS_REGULAR_IMPLEMENTATION
 #include <assets/OpenSans_Regular.h>
 #define TELEGRAMA_IMPLEMENTATION
-#include <assets/Telegrama.h>
+#include <assets/telegrama.h>
 gfx::const_buffer_stream opensans_regular_stm(OpenSans_Regular,sizeof(OpenSans_Regular));
 gfx::tt_font title_font = gfx::tt_font(opensans_regular_stm,40,gfx::font_size_units::px);
 gfx::const_buffer_stream telegrama_stm(telegrama,sizeof(telegrama));
 gfx::tt_font probe_font = gfx::tt_font(telegrama_stm,20,gfx::font_size_units::px);
 gfx::const_buffer_stream probe_stm(probe,sizeof(probe));
 gfx::tt_font probe_msg_font = gfx::tt_font(opensans_regular_stm,25,gfx::font_size_units::px);
+#endif
+// the probe text is redrawn constantly so
+// its glyphs are rasterized once and cached
+glyph_cache probe_font_cache(probe_font,PROBE_FONT_CACHE_SIZE);
 using namespace gfx;
 using namespace uix;
 // declare native pixel type color enum
@@ -27,12 +38,15 @@ ui_screen_t main_screen;
 
 // main screen controls
 ui_label_t title_label;
-ui_svg_box_t title_svg;
+ui_title_image_t title_svg;
 ui_painter_t probe_painter;
-ui_label_t probe_label;
+ui_terminal_t probe_label;
 ui_painter_t msg_painter;
 ui_label_t probe_msg_label1;
 ui_label_t probe_msg_label2;
+#ifdef FRAME_STATS_OVERLAY
+ui_label_t stats_label;
+#endif
 // holds how many cols and rows
 // are available
 uint16_t probe_cols = 0;
@@ -57,7 +71,13 @@ static void ui_init_main_screen() {
     title_label.bounds(main_screen.bounds());
     
     main_screen.register_control(title_label);
+#ifdef PACKED_ASSETS
+    title_svg.image(title_packed_image);
+#else
     title_svg.stream(probe_stm);
+    // the screen shows through around it
+    title_svg.matte(ctl_color_t::white);
+#endif
     title_svg.bounds(srect16(0,0,200,110).offset(10,0));
     main_screen.register_control(title_svg);
     probe_painter.bounds(main_screen.bounds());
@@ -65,29 +85,22 @@ static void ui_init_main_screen() {
     probe_painter.visible(false);
     main_screen.register_control(probe_painter);
     probe_label.color(ctl_color_t::white);
-    probe_label.font(probe_font);
-    probe_label.text_justify(uix_justify::center_left);
+    probe_label.font(probe_font_cache);
     probe_label.bounds(main_screen.bounds());
     probe_label.visible(false);
 
     main_screen.register_control(probe_label);
 
     // compute the probe columns and rows
+    // from the terminal's cell size
+    const size16 cell = probe_label.cell_size();
     probe_rows = (main_screen.dimensions().height-
         probe_label.padding().height*2)/
-        probe_font.line_height();
-    int probe_m;
-    // we use the standard method of measuring M
-    // to determine the font width. This really
-    // should be used with monospace fonts though
-    size16 tsz;
-    text_info ti;
-    ti.text_font = &probe_font;
-    ti.text_sz("M");
-    probe_font.measure(-1,ti,&tsz);
+        cell.height;
     probe_cols = (main_screen.dimensions().width-
         probe_label.padding().width*2)/
-        tsz.width;
+        cell.width;
+    probe_label.initialize(probe_cols,probe_rows);
     // now compute where our probe
     // configuration message labels
     // go
@@ -114,19 +127,31 @@ static void ui_init_main_screen() {
     main_screen.register_control(probe_msg_label1);
 
     probe_msg_label2.color(ctl_color_t::black);
-    probe_msg_label2.font(probe_font);
+    probe_msg_label2.font(probe_font_cache);
     probe_msg_label2.text_justify(uix_justify::center);
     b.offset_inplace(0,probe_msg_label1.bounds().height());
     probe_msg_label2.bounds(b);
     probe_msg_label2.visible(false);
 
     main_screen.register_control(probe_msg_label2);
+#ifdef FRAME_STATS_OVERLAY
+    // a line across the top, over everything else
+    stats_label.color(ctl_color_t::white);
+    stats_label.background_color(ctl_color_t::black.opacity(.6));
+    stats_label.font(probe_font_cache);
+    stats_label.text_justify(uix_justify::top_right);
+    stats_label.bounds(srect16(0,0,main_screen.dimensions().width-1,
+        probe_font_cache.line_height()+stats_label.padding().height*2-1));
+    stats_label.text("");
+    main_screen.register_control(stats_label);
+#endif
 
     main_screen.background_color(scr_color_t::white);
 }
 void ui_init() {
     title_font.initialize();
     probe_font.initialize();
+    probe_font_cache.initialize();
     probe_msg_font.initialize();
     ui_init_main_screen();
 }
\ No newline at end of file
@@ -0,0 +1,65 @@
+// checks the packed fonts and title image draw exactly
+// the pixels of the TrueType and SVG paths they're
+// packed from. pio test -e native
+#include <hal.hpp>
+#include <native/bench.hpp>
+#include <probe.hpp>
+#include <stdlib.h>
+#include <ui.hpp>
+#include <unity.h>
+using namespace gfx;
+
+// lcd panel data, like the bench's
+static constexpr const size_t lcd_buffer_size = gfx::bitmap<rgb_pixel<LCD_BIT_DEPTH>>::sizeof_buffer(LCD_WIDTH, LCD_HEIGHT / 5);
+static uint8_t* lcd_buffer1 = nullptr;
+
+// writes bitmap data to the frame buffer
+static void uix_on_flush(const rect16& bounds,
+                         const void* bmp,
+                         void* state) {
+    sim_fb.draw_bitmap(bounds.x1,
+                       bounds.y1,
+                       bounds.x2,
+                       bounds.y2,
+                       bmp);
+    main_screen.flush_complete();
+}
+
+void setUp() {
+}
+void tearDown() {
+}
+static void test_build() {
+    TEST_ASSERT_TRUE(pack_build());
+}
+static void test_glyphs() {
+    TEST_ASSERT_EQUAL_UINT(0, pack_glyph_mismatches());
+}
+static void test_title_image() {
+    TEST_ASSERT_TRUE(pack_title_matches());
+}
+static void test_probe_screen() {
+    TEST_ASSERT_TRUE(pack_screen_matches());
+}
+int main(int argc, char** argv) {
+    MONITOR.begin(115200);
+    lcd_buffer1 = (uint8_t*)malloc(lcd_buffer_size);
+    if (lcd_buffer1 == nullptr) {
+        return 1;
+    }
+    sim_fb.initialize(LCD_WIDTH, LCD_HEIGHT, LCD_BIT_DEPTH);
+    main_screen.dimensions({LCD_WIDTH, LCD_HEIGHT});
+    main_screen.buffer_size(lcd_buffer_size);
+    main_screen.buffer1(lcd_buffer1);
+    main_screen.on_flush_callback(uix_on_flush);
+    ui_init();
+    if (!probe_init()) {
+        return 1;
+    }
+    UNITY_BEGIN();
+    RUN_TEST(test_build);
+    RUN_TEST(test_glyphs);
+    RUN_TEST(test_title_image);
+    RUN_TEST(test_probe_screen);
+    return UNITY_END();
+}
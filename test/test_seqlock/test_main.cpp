@@ -0,0 +1,117 @@
+// hammers the i2c address seqlock from a writer and
+// several readers, checking no read comes back torn
+// or out of order. pio test -e native
+#include <seqlock.hpp>
+#include <stdio.h>
+#include <string.h>
+#include <unity.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+// the i2c address bitmap, with every word set to the
+// write number so a torn copy shows as words that differ
+struct test_seqlock_value {
+    uint32_t banks[4];
+};
+static const size_t test_seqlock_readers = 3;
+static const uint32_t test_seqlock_ms = 1000;
+
+static seqlock<test_seqlock_value> test_seqlock_shared;
+// the same words written with no sequence around them,
+// to show the check catches torn copies
+static std::atomic<uint32_t> test_seqlock_unguarded[4];
+static std::atomic_bool test_seqlock_done(false);
+
+struct test_seqlock_reader {
+    size_t reads;
+    size_t torn;
+    size_t stale;
+    size_t unguarded_torn;
+};
+
+static void test_seqlock_write() {
+    test_seqlock_value value;
+    uint32_t writes = 0;
+    while (!test_seqlock_done) {
+        ++writes;
+        for (int i = 0; i < 4; ++i) {
+            value.banks[i] = writes;
+        }
+        test_seqlock_shared.write(value);
+        for (int i = 0; i < 4; ++i) {
+            test_seqlock_unguarded[i].store(writes, std::memory_order_relaxed);
+        }
+    }
+}
+static void test_seqlock_read(test_seqlock_reader* out_reader) {
+    test_seqlock_reader reader;
+    memset(&reader, 0, sizeof(reader));
+    uint32_t last_generation = 0;
+    while (!test_seqlock_done) {
+        test_seqlock_value value;
+        const uint32_t generation = test_seqlock_shared.read(&value);
+        ++reader.reads;
+        // every word should be the same write, the one
+        // the generation says, and it never goes back
+        for (int i = 0; i < 4; ++i) {
+            if (value.banks[i] != generation) {
+                ++reader.torn;
+                break;
+            }
+        }
+        if (generation < last_generation) {
+            ++reader.stale;
+        }
+        last_generation = generation;
+        uint32_t first = test_seqlock_unguarded[0].load(std::memory_order_relaxed);
+        for (int i = 1; i < 4; ++i) {
+            if (test_seqlock_unguarded[i].load(std::memory_order_relaxed) != first) {
+                ++reader.unguarded_torn;
+                break;
+            }
+        }
+    }
+    *out_reader = reader;
+}
+
+void setUp() {
+}
+void tearDown() {
+}
+static void test_no_torn_reads() {
+    test_seqlock_reader readers[test_seqlock_readers];
+    std::thread reader_threads[test_seqlock_readers];
+    for (size_t i = 0; i < test_seqlock_readers; ++i) {
+        reader_threads[i] = std::thread(test_seqlock_read, &readers[i]);
+    }
+    std::thread writer_thread(test_seqlock_write);
+    std::this_thread::sleep_for(std::chrono::milliseconds(test_seqlock_ms));
+    test_seqlock_done = true;
+    writer_thread.join();
+    size_t reads = 0;
+    size_t torn = 0;
+    size_t stale = 0;
+    size_t unguarded_torn = 0;
+    for (size_t i = 0; i < test_seqlock_readers; ++i) {
+        reader_threads[i].join();
+        reads += readers[i].reads;
+        torn += readers[i].torn;
+        stale += readers[i].stale;
+        unguarded_torn += readers[i].unguarded_torn;
+    }
+    // how often the same copy tears without the sequence.
+    // it depends on the host, so it's only reported
+    char msg[64];
+    snprintf(msg, sizeof(msg), "unguarded: %zu of %zu reads torn", unguarded_torn, reads);
+    TEST_MESSAGE(msg);
+    TEST_ASSERT_NOT_EQUAL(0, reads);
+    TEST_ASSERT_EQUAL_UINT(0, torn);
+    TEST_ASSERT_EQUAL_UINT(0, stale);
+}
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_no_torn_reads);
+    return UNITY_END();
+}
@@ -0,0 +1,31 @@
+# PlatformIO pre script. When the environment builds with
+# -DPACKED_ASSETS this generates include/assets/packed_assets.h
+# from the fonts and SVG by building the native program and
+# running it with -P. It's only regenerated when the assets
+# or the code that draws them are newer than the header
+Import("env")
+import os
+import subprocess
+
+defines = env.ParseFlags(env.subst("$BUILD_FLAGS")).get("CPPDEFINES", [])
+names = [d[0] if isinstance(d, (list, tuple)) else d for d in defines]
+
+if "PACKED_ASSETS" in names:
+    project = env.subst("$PROJECT_DIR")
+    header = os.path.join(project, "include", "assets", "packed_assets.h")
+    sources = [
+        os.path.join(project, "include", "assets", "OpenSans_Regular.h"),
+        os.path.join(project, "include", "assets", "telegrama.h"),
+        os.path.join(project, "include", "assets", "probe.h"),
+        os.path.join(project, "include", "ui.hpp"),
+        os.path.join(project, "src", "ui.cpp"),
+        os.path.join(project, "src", "native", "pack_assets.cpp"),
+    ]
+    stale = not os.path.exists(header) or any(
+        os.path.getmtime(s) > os.path.getmtime(header) for s in sources)
+    if stale:
+        print("Packing assets into " + header)
+        subprocess.check_call([env.subst("$PYTHONEXE"), "-m", "platformio",
+                               "run", "-e", "native", "-d", project])
+        program = os.path.join(project, ".pio", "build", "native", "program")
+        subprocess.check_call([program, "-P", header])